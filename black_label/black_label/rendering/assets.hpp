@@ -2,9 +2,18 @@
 #define BLACK_LABEL_RENDERING_ASSETS_HPP
 
 #include <black_label/rendering/cpu/model.hpp>
+#include <black_label/rendering/gpu/geometry_arena.hpp>
 #include <black_label/rendering/gpu/model.hpp>
+#include <black_label/rendering/instance_batches.hpp>
+#include <black_label/rendering/memory_statistics.hpp>
+#include <black_label/utility/cache_archive.hpp>
 #include <black_label/utility/threading_building_blocks/path.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
 #include <unordered_map>
 #include <unordered_set>
 #include <tuple>
@@ -65,9 +74,9 @@ public:
 
 	// Emptied by calling remove_statics
 	entities_container statics;
-	// Never emptied
+	// Expired entries are erased by sweep_expired_resources
 	model_map models;
-	// Never emptied
+	// Expired entries are erased by sweep_expired_resources
 	gpu::texture_map textures;
 
 	// Emptied by calling update
@@ -77,22 +86,53 @@ public:
 	// Emptied by calling import_missing_models
 	missing_model_file_container missing_model_files;
 
-	// Emptied by calling update
+	// The vertices and indices of all models
+	gpu::geometry_arenas static_geometry;
+	// Rebuilt by calling update if statics_revision changed
+	instance_batches static_instances;
+	// Changes whenever statics are added, updated or removed, or their models
+	// are uploaded
+	std::size_t statics_revision;
+
+	// Updated by calling update. References the lights of static_lights.
 	light_container lights, shadow_casting_lights;
-	// N/A
+	// One light_block per shadow-casting light (see light::uniform_block_offset)
 	gpu::buffer light_buffer;
 
 	// Not thread-safe. Do not change while member functions are running
 	// except for import_task (which creates a local copy).
 	path asset_directory;
+	// Packed cache files of the asset directory. Not thread-safe. Do not 
+	// reopen while imports are running.
+	utility::cache_archive archive;
 	// N/A
 	tbb::task_group import_group;
 
+	// Bytes of GPU memory that textures may use before the least-recently-rendered 
+	// textures lose mipmap levels. Zero disables the budget. Not thread-safe.
+	memory_statistics::size_type gpu_memory_budget;
+	// Time between memory statistics log entries. Zero disables the log. Not thread-safe.
+	std::chrono::steady_clock::duration memory_statistics_interval;
+	// Number of calls to update between sweeps of expired models and textures. 
+	// Zero disables sweeping. Not thread-safe.
+	unsigned int sweep_interval;
+
 
 
 	assets( path asset_directory ) 
-		: asset_directory(std::move(asset_directory)) 
-		, light_buffer{gpu::target::uniform_buffer, gpu::usage::dynamic_draw, 148}
+		: statics_revision{0}
+		, light_buffer{gpu::target::uniform_buffer, gpu::usage::dynamic_draw}
+		, asset_directory(std::move(asset_directory)) 
+		, archive{this->asset_directory / utility::cache_archive::default_file_name()}
+		, gpu_memory_budget{0}
+		, memory_statistics_interval{std::chrono::minutes{1}}
+		, sweep_interval{60}
+		, expired_models{std::make_shared<expired_resources>()}
+		, expired_textures{std::make_shared<expired_resources>()}
+		, sweeping{false}
+		, cpu_staging_size{0}
+		, last_memory_statistics_log{std::chrono::steady_clock::now()}
+		, gpu_memory_budget_unmet{false}
 	{}
 	assets( const assets& other ) = delete;
 	~assets() {
@@ -106,12 +146,15 @@ public:
 		using namespace gpu;
 
 		// Process removed entities
-		bool static_lights_need_update{false};
 		for (external_entities entities; removed_statics.try_pop(entities);) {
-			statics.erase(get<id_type>(entities));
-			static_lights_need_update = true;
+			auto existing = statics.find(get<id_type>(entities));
+			if (statics.end() == existing) continue;
+			remove_model_users(existing->first, get<model_container>(existing->second));
+			remove_entity_lights(existing->first);
+			dirty_light_entities.erase(existing->first);
+			statics.erase(existing);
+			++statics_revision;
 		}
-		if (static_lights_need_update) update_static_lights();
 
 		// Process dirty (new or updated) entities
 		for (external_entities entities; dirty_statics.try_pop(entities);) {
@@ -128,20 +171,19 @@ public:
 				file.make_preferred();
 				{
 					model_map::accessor accessor;
-					auto new_model = make_shared<model>();
 
 					// Ignore if the file doesn't exist in the asset_directory
 					// since missing models will be caught in a later step.
 					try_canonical_and_preferred(file, asset_directory);
 
-					// Attempt to insert new_model
-					models.insert(accessor, {file, new_model});
-					// The returned model can be either the new_model or an existing model
+					// Attempt to insert an empty entry
+					models.insert(accessor, file);
+					// The returned entry can be either the new entry or an existing entry
 					auto model = accessor->second.lock();
-					// The model has expired. Thus the insertion must have returned an existing model...
+					// The entry is new or its model has expired...
 					if (!model)
-						// ...which is replaced.
-						accessor->second = model = move(new_model);
+						// ...in which case a model is created.
+						accessor->second = model = make_resource<gpu::model>(file, expired_models);
 
 					associated_models.emplace_back(move(model));
 				}
@@ -151,9 +193,17 @@ public:
 			}
 
 			// Existing entities
-			if (statics.end() != existing) get<model_container>(existing->second) = move(associated_models);
+			if (statics.end() != existing) {
+				remove_model_users(existing->first, get<model_container>(existing->second));
+				get<model_container>(existing->second) = move(associated_models);
+			}
 			// New entities
-			else statics.emplace(std::piecewise_construct, forward_as_tuple(get<id_type>(entities)), forward_as_tuple(get<model_file_range>(entities), get<transformation_range>(entities), move(associated_models)));
+			else existing = statics.emplace(std::piecewise_construct, forward_as_tuple(get<id_type>(entities)), forward_as_tuple(get<model_file_range>(entities), get<transformation_range>(entities), move(associated_models))).first;
+
+			for (const auto& model : get<model_container>(existing->second))
+				model_users[model.get()].insert(existing->first);
+			dirty_light_entities.insert(existing->first);
+			++statics_revision;
 		}
 	}
 	// Thread-safe; immediate (enqueues a parallel task and returns)
@@ -161,6 +211,19 @@ public:
 		for (path file; dirty_model_files.try_pop(file);)
 			import_group.run([this, file = std::move(file)] { import_model(std::move(file), asset_directory); });
 	}
+	// Not thread-safe; blocking (waits for running imports)
+	bool open_cache_archive() {
+		import_group.wait();
+		return archive.open(asset_directory / utility::cache_archive::default_file_name());
+	}
+	// Not thread-safe; blocking (waits for running imports)
+	bool pack_cache_archive() {
+		import_group.wait();
+		// Unmap the archive before it is overwritten
+		archive = utility::cache_archive{};
+		auto file = asset_directory / utility::cache_archive::default_file_name();
+		return utility::cache_archive::pack(asset_directory, file) && archive.open(file);
+	}
 	// Thread-safe; immediate (enqueues a parallel task and returns)
 	void import_missing_models() {
 		// Make a local copy of the currently missing model files...
@@ -175,13 +238,14 @@ public:
 	}
 	// Must be called by an OpenGL thread
 	void upload_models() {
-		bool static_lights_need_update{false};
 		for (models_to_upload_container::value_type entry; models_to_upload.try_pop(entry);)
 		{
 			auto& file = std::get<0>(entry);
+			cpu_staging_size -= std::get<1>(entry).size();
 
 			model_map::accessor accessor;
-			if (!models.find(accessor, file)) assert(false);
+			// The entry may have been swept if the model expired
+			if (!models.find(accessor, file)) continue;
 
 			auto gpu_model = accessor->second.lock();
 
@@ -192,61 +256,32 @@ public:
 
 			auto& cpu_model = std::get<1>(entry);
 
-			*gpu_model = gpu::model{std::move(cpu_model), textures};
-
-			if (gpu_model->has_lights()) static_lights_need_update = true;
+			// The lights of the entities that use this model change if the model 
+			// had or now has lights.
+			bool had_lights{gpu_model->has_lights()};
+			*gpu_model = gpu::model{std::move(cpu_model), textures, static_geometry};
+			// The meshes and bounds of the model changed
+			++statics_revision;
+
+			if (had_lights || gpu_model->has_lights()) {
+				auto users = model_users.find(gpu_model.get());
+				if (model_users.end() != users)
+					dirty_light_entities.insert(users->second.begin(), users->second.end());
+			}
 		}
-
-		if (static_lights_need_update) update_static_lights();
 	}
-	// Not thread-safe
+	// Not thread-safe; must be called by an OpenGL thread
 	void update_static_lights() {
-		using namespace gpu;
 		using namespace std;
-		using namespace boost::adaptors;
 
-		lights.clear();
-		shadow_casting_lights.clear();
-
-		for (auto entities : statics | map_values) {
-			for (auto model_and_matrix : combine(get<model_container>(entities), get<transformation_range>(entities))) {
-				const auto& model = get<0>(model_and_matrix);
-				const auto& model_matrix = get<1>(model_and_matrix);
-
-				for (light& light : model->lights) {
-					light.position = glm::vec3(model_matrix * glm::vec4(light.position, 1.0f));
-					lights.push_back(light);
-				
-					if (light_type::spot == light.type) {
-						light.view = view{
-							light.position, 
-							light.position + light.direction, 
-							glm::vec3{0.0, 1.0, 0.0},
-							800,
-							800,
-							10.0f,
-							10000.0f};
-						light.shadow_map = storage_texture{target::texture_2d, format::depth32f, filter::nearest, wrap::clamp_to_edge, 1.0, 1.0};
-						light.shadow_map.bind_and_update(light.view.window.x, light.view.window.y);
-
-						struct light_uniform_block {
-							glm::mat4 projection_matrix, view_projection_matrix;
-							glm::vec4 wc_direction;
-							float radius;
-						} light_uniform_block;
-						static_assert(148 == sizeof(light_uniform_block), "light_uniform_block must match the OpenGL GLSL layout(140) specification.");
-						light_uniform_block.projection_matrix = light.view.projection_matrix;
-						light_uniform_block.view_projection_matrix = light.view.view_projection_matrix;
-						light_uniform_block.wc_direction = glm::vec4(light.view.forward(), 1.0);
-						light_uniform_block.radius = 50.0f;
-
-						light_buffer.bind_and_update(sizeof(light_uniform_block), &light_uniform_block);
-
-						shadow_casting_lights.push_back(light);
-					}
-				}
-			}
+		for (const auto& id : dirty_light_entities) {
+			remove_entity_lights(id);
+			auto existing = statics.find(id);
+			if (statics.end() != existing) add_entity_lights(id, existing->second);
 		}
+		dirty_light_entities.clear();
+
+		upload_light_uniform_blocks();
 	}
 	// Must be called by an OpenGL thread
 	void upload_textures() {
@@ -254,9 +289,11 @@ public:
 
 		for (textures_to_upload_container::value_type entry; textures_to_upload.try_pop(entry);) {
 			auto& file = entry.first;
+			cpu_staging_size -= entry.second.size();
 
 			texture_map::accessor accessor;
-			if (!textures.find(accessor, file)) assert(false);
+			// The entry may have been swept if the texture expired
+			if (!textures.find(accessor, file)) continue;
 		
 			auto gpu_texture = accessor->second.lock();
 
@@ -272,10 +309,104 @@ public:
 	}
 	// Not thread-safe; must be called by an OpenGL thread
 	void update() {
+		++gpu::texture::current_frame;
 		update_statics();
 		update_models();
 		upload_textures();
 		upload_models();
+		update_static_lights();
+		static_instances.update(statics, statics_revision);
+		enforce_gpu_memory_budget();
+		log_memory_statistics();
+
+		auto epoch = ++expired_models->epoch;
+		++expired_textures->epoch;
+		if (0 != sweep_interval && 0 == epoch % sweep_interval) sweep_expired_resources();
+	}
+	// Thread-safe; immediate (enqueues a parallel task and returns)
+	void sweep_expired_resources() {
+		// At most one sweep at a time
+		if (sweeping.exchange(true)) return;
+		import_group.run([this] {
+			sweep(models, *expired_models);
+			sweep(textures, *expired_textures);
+			sweeping = false;
+		});
+	}
+
+	// Not thread-safe
+	memory_statistics get_memory_statistics() const {
+		memory_statistics result;
+		result.cpu_staging = cpu_staging_size;
+		result.live_model_entries = expired_models->live;
+		result.expired_model_entries = expired_models->expired;
+		result.live_texture_entries = expired_textures->live;
+		result.expired_texture_entries = expired_textures->expired;
+		// The models are stored in the arenas. Counts the unused arena space too.
+		result.gpu_buffers = static_geometry.size();
+		for_each_gpu_resource(
+			[&result] ( const gpu::model& ) { ++result.model_count; },
+			[&result] ( const gpu::texture& texture ) {
+				++result.texture_count;
+				auto size = texture.size();
+				result.gpu_textures += size;
+				result.gpu_textures_uncompressed += texture.uncompressed_size();
+				if (texture.has_compressed_format()) result.gpu_textures_compressed += size;
+			});
+		return result;
+	}
+	// Not thread-safe; must be called by an OpenGL thread
+	void enforce_gpu_memory_budget() {
+		using namespace std;
+
+		if (0 == gpu_memory_budget) return;
+
+		auto statistics = get_memory_statistics();
+		auto gpu_total = statistics.gpu_total();
+		if (gpu_memory_budget >= gpu_total) {
+			gpu_memory_budget_unmet = false;
+			return;
+		}
+
+		// Least-recently-rendered textures first
+		vector<gpu::texture*> candidates;
+		for_each_gpu_resource(
+			[] ( const gpu::model& ) {},
+			[&candidates] ( gpu::texture& texture ) { candidates.push_back(&texture); });
+		sort(candidates.begin(), candidates.end(), [] ( const auto lhs, const auto rhs )
+			{ return lhs->last_used_frame < rhs->last_used_frame; });
+
+		// Drop at most a single mipmap level per texture per call. Subsequent
+		// calls (i.e., frames) continue until the budget is met.
+		auto dropped = false;
+		for (auto texture : candidates) {
+			auto size = texture->size();
+			if (!texture->drop_mipmap_level()) continue;
+			dropped = true;
+			gpu_total -= size - texture->size();
+			if (gpu_memory_budget >= gpu_total) break;
+		}
+
+		if (dropped)
+			BOOST_LOG_TRIVIAL(info) << "Reduced texture memory to meet the GPU memory budget: "
+				<< gpu_total * 1.0e-6 << " of " << gpu_memory_budget * 1.0e-6 << " MB";
+		// No texture has a level left to drop
+		else if (!gpu_memory_budget_unmet) {
+			gpu_memory_budget_unmet = true;
+			BOOST_LOG_TRIVIAL(warning) << "Cannot meet the GPU memory budget: "
+				<< gpu_total * 1.0e-6 << " of " << gpu_memory_budget * 1.0e-6 << " MB";
+		}
+	}
+	// Not thread-safe
+	void log_memory_statistics() {
+		using namespace std::chrono;
+
+		if (steady_clock::duration::zero() == memory_statistics_interval) return;
+		auto now = steady_clock::now();
+		if (memory_statistics_interval > now - last_memory_statistics_log) return;
+		last_memory_statistics_log = now;
+
+		BOOST_LOG_TRIVIAL(info) << "Rendering asset memory:\n" << get_memory_statistics();
 	}
 	// Thread-safe; immediate (enqueues a parallel task and returns)
 	bool reload_model( path file ) {
@@ -323,6 +454,54 @@ public:
 
 
 private:
+	using epoch_type = std::uint64_t;
+
+	// Resources whose last shared_ptr has been released. Shared with the 
+	// deleters since resources may outlive the assets.
+	struct expired_resources {
+		expired_resources() : epoch{0}, live{0}, expired{0} {}
+
+		tbb::concurrent_queue<std::pair<path, epoch_type>> files;
+		std::atomic<epoch_type> epoch;
+		std::atomic<std::size_t> live, expired;
+	};
+
+	// Thread-safe
+	template<typename resource>
+	static std::shared_ptr<resource> make_resource( path file, const std::shared_ptr<expired_resources>& expired_resources ) {
+		++expired_resources->live;
+		return {new resource, [expired_resources, file = std::move(file)] ( resource* pointer ) {
+			delete pointer;
+			--expired_resources->live;
+			++expired_resources->expired;
+			expired_resources->files.push({file, expired_resources->epoch});
+		}};
+	}
+
+	// Thread-safe; blocking. Only erases entries that expired in an earlier epoch 
+	// and that are still expired. The write accessor excludes concurrent imports 
+	// of the same file.
+	template<typename resource>
+	static void sweep( concurrent_resource_map<resource>& map, expired_resources& expired_resources ) {
+		auto epoch = expired_resources.epoch.load();
+		for (std::pair<path, epoch_type> entry; expired_resources.files.try_pop(entry);) {
+			if (epoch <= entry.second) {
+				expired_resources.files.push(std::move(entry));
+				break;
+			}
+
+			{
+				typename concurrent_resource_map<resource>::accessor accessor;
+				if (map.find(accessor, entry.first) && accessor->second.expired())
+					map.erase(accessor);
+			}
+			--expired_resources.expired;
+		}
+	}
+
+	std::shared_ptr<expired_resources> expired_models, expired_textures;
+	std::atomic<bool> sweeping;
+
 	using models_to_upload_container = tbb::concurrent_queue<std::tuple<path, cpu::model, std::vector<std::shared_ptr<gpu::texture>>>>;
 	using textures_to_upload_container = tbb::concurrent_queue<std::pair<path, cpu::texture>>;
 
@@ -331,6 +510,208 @@ private:
 	// Emptied by calling update
 	textures_to_upload_container textures_to_upload;
 
+	// Bytes held by models_to_upload and textures_to_upload
+	std::atomic<memory_statistics::size_type> cpu_staging_size;
+	std::chrono::steady_clock::time_point last_memory_statistics_log;
+	// Whether the last call to enforce_gpu_memory_budget could not meet the
+	// budget, i.e., whether the warning was logged
+	bool gpu_memory_budget_unmet;
+
+	// World-space lights of a single static entity
+	struct entity_lights {
+		std::vector<light> lights;
+		// Position of each light within assets::lights and assets::shadow_casting_lights
+		std::vector<std::size_t> light_indices, shadow_casting_light_indices;
+	};
+
+	// Node-based so that the references in lights and shadow_casting_lights stay valid
+	std::unordered_map<id_type, entity_lights> static_lights;
+	// For each entry in lights (and shadow_casting_lights): the index that refers back to it
+	std::vector<std::size_t*> light_owners, shadow_casting_light_owners;
+	// Emptied by calling update_static_lights
+	std::unordered_set<id_type> dirty_light_entities;
+	// The static entities that reference each model
+	std::unordered_map<const gpu::model*, std::unordered_set<id_type>> model_users;
+	// Shadow maps of removed lights ready for reuse
+	std::vector<gpu::storage_texture> shadow_map_pool;
+	// Indices into shadow_casting_lights whose light_block must be uploaded
+	std::vector<std::size_t> dirty_light_uniform_blocks;
+
+
+
+	// Not thread-safe
+	void remove_model_users( const id_type& id, const model_container& models ) {
+		for (const auto& model : models) {
+			auto users = model_users.find(model.get());
+			if (model_users.end() == users) continue;
+			users->second.erase(id);
+			if (users->second.empty()) model_users.erase(users);
+		}
+	}
+
+	// Not thread-safe. Swap-and-pop so that removal is O(1) per light.
+	static void remove_light( light_container& container, std::vector<std::size_t*>& owners, std::size_t index ) {
+		container[index] = container.back();
+		owners[index] = owners.back();
+		*owners[index] = index;
+		container.pop_back();
+		owners.pop_back();
+	}
+
+	// Not thread-safe
+	void remove_entity_lights( const id_type& id ) {
+		auto existing = static_lights.find(id);
+		if (static_lights.end() == existing) return;
+		auto& entity = existing->second;
+
+		// Remove in descending order so that swap-and-pop never moves a light
+		// of this entity after it has been removed.
+		std::vector<std::size_t> indices{entity.light_indices};
+		std::sort(indices.rbegin(), indices.rend());
+		for (auto index : indices) remove_light(lights, light_owners, index);
+
+		indices = entity.shadow_casting_light_indices;
+		std::sort(indices.rbegin(), indices.rend());
+		for (auto index : indices) {
+			remove_light(shadow_casting_lights, shadow_casting_light_owners, index);
+			// The light that took this slot must update its light_block
+			if (shadow_casting_lights.size() > index) dirty_light_uniform_blocks.push_back(index);
+		}
+
+		for (auto& light : entity.lights)
+			if (light.shadow_map) shadow_map_pool.emplace_back(std::move(light.shadow_map));
+
+		static_lights.erase(existing);
+	}
+
+	// Not thread-safe; must be called by an OpenGL thread
+	void add_entity_lights( const id_type& id, const entities& entities ) {
+		using namespace gpu;
+		using namespace std;
+
+		auto& entity = static_lights[id];
+
+		for (auto model_and_matrix : combine(get<model_container>(entities), get<transformation_range>(entities))) {
+			const auto& model = get<0>(model_and_matrix);
+			const auto& model_matrix = get<1>(model_and_matrix);
+
+			for (const light& model_light : model->lights) {
+				entity.lights.emplace_back(
+					model_light.type, 
+					glm::vec3(model_matrix * glm::vec4(model_light.position, 1.0f)), 
+					model_light.direction, 
+					model_light.color);
+				auto& light = entity.lights.back();
+
+				if (light_type::spot != light.type) continue;
+
+				light.view = view{
+					light.position, 
+					light.position + light.direction, 
+					glm::vec3{0.0, 1.0, 0.0},
+					800,
+					800,
+					10.0f,
+					10000.0f};
+
+				if (!shadow_map_pool.empty()) {
+					light.shadow_map = move(shadow_map_pool.back());
+					shadow_map_pool.pop_back();
+				} else {
+					light.shadow_map = storage_texture{target::texture_2d, format::depth32f, filter::nearest, wrap::clamp_to_edge, 1.0, 1.0};
+					light.shadow_map.bind_and_update(light.view.window.x, light.view.window.y);
+				}
+			}
+		}
+
+		if (entity.lights.empty()) {
+			static_lights.erase(id);
+			return;
+		}
+
+		// The owners point into the index vectors so these must not be resized afterwards
+		entity.light_indices.resize(entity.lights.size());
+		entity.shadow_casting_light_indices.resize(count_if(entity.lights.begin(), entity.lights.end(), 
+			[] ( const light& light ) { return static_cast<bool>(light.shadow_map); }));
+
+		auto light_index = entity.light_indices.begin();
+		auto shadow_casting_light_index = entity.shadow_casting_light_indices.begin();
+		for (auto& light : entity.lights) {
+			*light_index = lights.size();
+			light_owners.push_back(&*light_index++);
+			lights.push_back(light);
+
+			if (!light.shadow_map) continue;
+			*shadow_casting_light_index = shadow_casting_lights.size();
+			shadow_casting_light_owners.push_back(&*shadow_casting_light_index++);
+			dirty_light_uniform_blocks.push_back(shadow_casting_lights.size());
+			shadow_casting_lights.push_back(light);
+		}
+	}
+
+	// Not thread-safe; must be called by an OpenGL thread
+	void upload_light_uniform_blocks() {
+		using namespace gpu;
+
+		if (dirty_light_uniform_blocks.empty()) return;
+
+		auto alignment = buffer::uniform_buffer_offset_alignment();
+		buffer::size_type block_size{light::uniform_block_size};
+		auto slot_size = (block_size + alignment - 1) / alignment * alignment;
+		auto required_size = static_cast<buffer::size_type>(shadow_casting_lights.size()) * slot_size;
+
+		// Grow geometrically. Reallocation discards the contents so everything is uploaded.
+		light_buffer.bind();
+		if (light_buffer.allocated_size < required_size) {
+			light_buffer.update(std::max(required_size, 2 * light_buffer.allocated_size));
+			dirty_light_uniform_blocks.resize(shadow_casting_lights.size());
+			std::iota(dirty_light_uniform_blocks.begin(), dirty_light_uniform_blocks.end(), std::size_t{0});
+		}
+
+		struct light_uniform_block {
+			glm::mat4 projection_matrix, view_projection_matrix;
+			glm::vec4 wc_direction;
+			float radius;
+		} light_uniform_block;
+		static_assert(light::uniform_block_size == sizeof(light_uniform_block), "light_uniform_block must match the OpenGL GLSL layout(140) specification.");
+
+		for (auto index : dirty_light_uniform_blocks) {
+			if (shadow_casting_lights.size() <= index) continue;
+			light& light = shadow_casting_lights[index];
+
+			light.uniform_block_offset = index * slot_size;
+			light_uniform_block.projection_matrix = light.view.projection_matrix;
+			light_uniform_block.view_projection_matrix = light.view.view_projection_matrix;
+			light_uniform_block.wc_direction = glm::vec4(light.view.forward(), 1.0);
+			light_uniform_block.radius = 50.0f;
+
+			light_buffer.update(light.uniform_block_offset, block_size, &light_uniform_block);
+		}
+		dirty_light_uniform_blocks.clear();
+	}
+
+
+
+	// Not thread-safe. Visits each GPU model and texture referenced by the statics once.
+	template<typename model_callable, typename texture_callable>
+	void for_each_gpu_resource( model_callable on_model, texture_callable on_texture ) const {
+		using namespace std;
+		using namespace boost::adaptors;
+
+		unordered_set<const gpu::model*> visited_models;
+		unordered_set<const gpu::texture*> visited_textures;
+
+		for (const auto& entities : statics | map_values)
+			for (const auto& model : get<model_container>(entities)) {
+				if (!model || !visited_models.insert(model.get()).second) continue;
+				on_model(*model);
+
+				for (const auto& mesh : model->meshes)
+					for (auto texture : {mesh.diffuse.get(), mesh.specular.get()})
+						if (texture && texture->valid() && visited_textures.insert(texture).second)
+							on_texture(*texture);
+			}
+	}
 
 
 	// Thread-safe; blocking
@@ -361,13 +742,15 @@ private:
 		if (!try_get(models, file, gpu_model)) return;
 
 
-		cpu::model cpu_model{canonical_file, defer_import};
+		// The file is read once. Both the checksum and the importer use these bytes.
+		file_buffer::file_buffer source{canonical_file.string()};
+		cpu::model cpu_model{source, defer_import};
 
 		// No need to load unmodified models
 		if (gpu_model->checksum == cpu_model.checksum) return;
 
 		// Import the model
-		if (!cpu_model.import(canonical_file)) return;
+		if (!cpu_model.import(canonical_file, source, &archive)) return;
 
 		// Handle textures
 		unordered_set<path> texture_files;
@@ -383,16 +766,15 @@ private:
 		for (const auto& texture_file : texture_files)
 		{
 			texture_map::accessor accessor;
-			auto new_texture = make_shared<texture>();
 
-			// Attempt to insert new_texture
-			textures.insert(accessor, {texture_file, new_texture});
-			// The returned texture can be either the new_texture or an existing texture
+			// Attempt to insert an empty entry
+			textures.insert(accessor, texture_file);
+			// The returned entry can be either the new entry or an existing entry
 			auto texture = accessor->second.lock();
-			// The texture has expired. Thus the insertion must have returned an existing texture...
+			// The entry is new or its texture has expired...
 			if (!texture)
-				// ...which is replaced.
-				accessor->second = texture = move(new_texture);
+				// ...in which case a texture is created.
+				accessor->second = texture = make_resource<gpu::texture>(texture_file, expired_textures);
 
 			gpu_textures.emplace_back(move(texture));
 		}
@@ -400,6 +782,7 @@ private:
 		for (const auto& texture_file : texture_files) 
 			import_group.run([this, texture_file] { import_texture(move(texture_file)); });
 
+		cpu_staging_size += cpu_model.size();
 		models_to_upload.push(make_tuple(move(canonical_file), move(cpu_model), move(gpu_textures)));
 	}
 	// Thread-safe; blocking
@@ -410,14 +793,18 @@ private:
 		shared_ptr<texture> gpu_texture;
 		if (!try_get(textures, file, gpu_texture)) return;
 
-		cpu::texture cpu_texture{file, defer_import};
+		// The file is read once. Both the checksum and the decoder use these bytes.
+		file_buffer::file_buffer source{file.string()};
+		cpu::texture cpu_texture{source, defer_import};
 
 		// No need to load unmodified textures
 		if (gpu_texture->checksum == cpu_texture.checksum) return;
 
 		// Import the texture
-		if (cpu_texture.import(file))
+		if (cpu_texture.import(file, source, &archive)) {
+			cpu_staging_size += cpu_texture.size();
 			textures_to_upload.push({move(file), move(cpu_texture)});
+		}
 	}
 };
 
@@ -61,6 +61,15 @@ public:
 
 
 
+	// Bytes of CPU memory used by the vertex and index data
+	std::size_t size() const
+	{
+		return sizeof(float) * (vertices.size() + normals.size() + texture_coordinates.size())
+			+ sizeof(unsigned int) * indices.size();
+	}
+
+
+
 	template<typename archive_type>
 	void serialize( archive_type& archive, unsigned int version )
 	{
@@ -34,22 +34,40 @@ public:
 
 	model() {}
 	model( path path, defer_import_type ) : cache_file{path} {}
-	explicit model( path path ) : model{path, defer_import}
-	{ import(std::move(path)); }
+	model( const file_buffer::file_buffer& source, defer_import_type ) : cache_file{source} {}
+	explicit model( path path ) : model{} 
+	{ 
+		file_buffer::file_buffer source{path.string()};
+		checksum = utility::checksum{source};
+		import(path, source);
+	}
 	model( model&& other ) { swap(*this, other); }
 	model& operator=( model rhs ) { swap(*this, rhs); return *this; }
 	
-	bool import( path path );
+	// Tries the archive (if any) before the loose cache file and the source file
+	bool import( path path, const utility::cache_archive* archive = nullptr );
+	// As above but parses source (the contents of path) instead of reading path again
+	bool import( const path& path, const file_buffer::file_buffer& source, const utility::cache_archive* archive = nullptr );
+	// Only parses source and exports the cache file; no cache is tried
+	bool import_source( const path& path, const file_buffer::file_buffer& source );
 #ifdef DEVELOPER_TOOLS
 #ifndef NO_FBX
 	bool import_fbxsdk( path path );
 #endif // #ifndef NO_FBX
-	bool import_assimp( path path );
+	bool import_assimp( const path& path, const file_buffer::file_buffer& source );
 #endif // #ifdef DEVELOPER_TOOLS
 
 	bool is_empty() const { return meshes.empty(); }
 	explicit operator bool() const { return !is_empty(); }
 
+	// Bytes of CPU memory used by the mesh data
+	std::size_t size() const
+	{
+		std::size_t result{0};
+		for (const auto& mesh : meshes) result += mesh.size();
+		return result;
+	}
+
 
 
 	template<typename archive_type>
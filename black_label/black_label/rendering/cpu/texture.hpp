@@ -41,20 +41,34 @@ public:
 	
 	texture() : compressed{false} {}
 	texture( path path, defer_import_type ) : cache_file{std::move(path)}, compressed{false} {}
-	explicit texture( path path ) : texture{path, defer_import} { import(std::move(path)); }
+	texture( const file_buffer::file_buffer& source, defer_import_type ) : cache_file{source}, compressed{false} {}
+	explicit texture( path path ) : texture{} 
+	{ 
+		file_buffer::file_buffer source{path.string()};
+		checksum = utility::checksum{source};
+		import(path, source); 
+	}
 	texture( const texture& ) = delete;
 	texture( texture&& other ) : texture{} { swap(*this, other); }
 	texture& operator=( texture rhs ) { swap(*this, rhs); return *this; }
 
-	bool import( path path );
+	// Tries the archive (if any) before the loose cache file and the source file
+	bool import( path path, const utility::cache_archive* archive = nullptr );
+	// As above but decodes source (the contents of path) instead of reading path again
+	bool import( const path& path, const file_buffer::file_buffer& source, const utility::cache_archive* archive = nullptr );
+	// Only decodes source and exports the cache file; no cache is tried
+	bool import_source( const path& path, const file_buffer::file_buffer& source );
 #ifdef DEVELOPER_TOOLS
-	bool import_sfml( path path );
+	bool import_sfml( const path& path, const file_buffer::file_buffer& source );
 	void compress();
 #endif // #ifdef DEVELOPER_TOOLS
 
 	bool is_empty() const { return data.empty(); }
 	explicit operator bool() const { return !is_empty(); }
 
+	// Bytes of CPU memory used by the (possibly compressed) texel data
+	std::size_t size() const { return data.size(); }
+
 
 
 	template<typename archive_type>
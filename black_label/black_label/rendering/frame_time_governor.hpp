@@ -0,0 +1,61 @@
+#ifndef BLACK_LABEL_RENDERING_FRAME_TIME_GOVERNOR_HPP
+#define BLACK_LABEL_RENDERING_FRAME_TIME_GOVERNOR_HPP
+
+#include <black_label/rendering/pass.hpp>
+#include <black_label/rendering/render_graph.hpp>
+
+#include <chrono>
+#include <vector>
+
+
+
+namespace black_label {
+namespace rendering {
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Frame Time Governor
+///
+/// Adjusts the render scale of the scalable passes such that the GPU time of
+/// a frame meets the target. The time of a scalable pass is taken to be
+/// proportional to its pixel count, i.e., to the square of its render scale.
+/// The time of the other passes is taken to be fixed.
+///
+/// The timings are read back a few frames late (see gpu::timer_query). To not
+/// oscillate, the render scales change by at most max_step per frame and not
+/// at all while the frame time is within tolerance of the target. All
+/// scalable passes are scaled alike but within their own bounds.
+////////////////////////////////////////////////////////////////////////////////
+class frame_time_governor
+{
+public:
+	frame_time_governor() : target_frame_time{0} {}
+	explicit frame_time_governor( std::chrono::nanoseconds target_frame_time )
+		: target_frame_time{target_frame_time} {}
+
+	bool is_enabled() const
+	{ return std::chrono::nanoseconds::zero() < target_frame_time; }
+
+	// Scales the passes that are not culled for the next frame given the GPU
+	// time of the whole frame
+	void update( 
+		std::chrono::nanoseconds frame_time, 
+		const std::vector<pass>& passes, 
+		const render_graph& graph ) const;
+
+	// Disabled if zero
+	std::chrono::nanoseconds target_frame_time;
+
+	// Relative to the target frame time and the render scale, respectively
+	static const double tolerance, max_step;
+};
+
+
+
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
@@ -18,12 +18,12 @@ namespace gpu {
 ////////////////////////////////////////////////////////////////////////////////
 namespace target {
 	extern const type texture, array, element_array, uniform_buffer, 
-		shader_storage, atomic_counter;
+		shader_storage, atomic_counter, draw_indirect;
 } // namespace target
 
 namespace usage {
 	using type = unsigned int;
-	extern const type stream_draw, static_draw, dynamic_draw, dynamic_copy;
+	extern const type stream_draw, stream_read, static_draw, dynamic_draw, dynamic_copy;
 } // namespace usage
 
 
@@ -65,11 +65,15 @@ public:
 	bool valid() const { return invalid_id != id; }
 	void bind( target::type target ) const;
 	void bind( target::type target, index_type index ) const;
+	void bind( target::type target, index_type index, offset_type offset, size_type size ) const;
 	static void unbind( target::type target );
 	static void unbind();
 	void update( target::type target, usage::type usage, size_type size, const void* data = nullptr ) const;
 	void update( target::type target, offset_type offset, size_type size, const void* data = nullptr ) const;
 
+	// Offsets given to glBindBufferRange for uniform buffers must be multiples of this
+	static offset_type uniform_buffer_offset_alignment();
+
 	operator id_type() const { return id; }
 
 	id_type id;
@@ -99,15 +103,17 @@ public:
 		swap(static_cast<basic_buffer&>(lhs), static_cast<basic_buffer&>(rhs));
 		swap(lhs.target, rhs.target);
 		swap(lhs.usage, rhs.usage);
+		swap(lhs.allocated_size, rhs.allocated_size);
 	}
 
-	buffer() {};
+	buffer() : allocated_size{0} {};
 	buffer( const buffer& ) = delete;
 	buffer( buffer&& other ) : buffer{} { swap(*this, other); };
 	buffer( target::type target, usage::type usage ) 
 		: basic_buffer{black_label::rendering::generate}
 		, target{target} 
 		, usage{usage}
+		, allocated_size{0}
 	{}
 	buffer( 
 		target::type target,
@@ -117,6 +123,7 @@ public:
 		: basic_buffer{target, usage, size, data} 
 		, target{target}
 		, usage{usage}
+		, allocated_size{size}
 	{}
 
 	buffer& operator=( buffer rhs )	{ swap(*this, rhs); return *this; }
@@ -128,8 +135,10 @@ public:
 	{ basic_buffer::bind(target); }
 	void bind( index_type index ) const
 	{ basic_buffer::bind(target, index); }
+	void bind( index_type index, offset_type offset, size_type size ) const
+	{ basic_buffer::bind(target, index, offset, size); }
 	void update( size_type size, const void* data = nullptr ) const
-	{ basic_buffer::update(target, usage, size, data); }
+	{ basic_buffer::update(target, usage, size, data); allocated_size = size; }
 	void update( offset_type offset, size_type size, const void* data = nullptr ) const
 	{ basic_buffer::update(target, offset, size, data); }
 	void bind_and_update( size_type size, const void* data = nullptr ) const
@@ -141,6 +150,8 @@ public:
 
 	target::type target;
 	usage::type usage;
+	// Bytes of GPU memory reserved by the last (re)allocation
+	mutable size_type allocated_size;
 };
 
 
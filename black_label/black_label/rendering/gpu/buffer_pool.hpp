@@ -0,0 +1,98 @@
+#ifndef BLACK_LABEL_RENDERING_GPU_BUFFER_POOL_HPP
+#define BLACK_LABEL_RENDERING_GPU_BUFFER_POOL_HPP
+
+#include <black_label/rendering/gpu/buffer.hpp>
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Buffer Pool
+///
+/// Sizes buffers whose required size varies from frame to frame (e.g., the
+/// linked lists of the layered depth maps). Allocations grow geometrically
+/// to powers of two such that a growing requirement reallocates only a
+/// logarithmic number of times. They shrink only after the requirement has
+/// stayed below a quarter of the allocation for shrink_delay consecutive
+/// requests, and then to the largest requirement seen meanwhile. A
+/// requirement that fluctuates thus keeps its allocation across frames.
+///
+/// The entries are keyed by name and outlive the buffers; a buffer that
+/// replaces another (e.g., on reload) continues its statistics.
+///
+/// Not thread-safe; must be used by the OpenGL thread.
+////////////////////////////////////////////////////////////////////////////////
+class buffer_pool
+{
+public:
+	using size_type = buffer::size_type;
+
+	struct entry {
+		// The last required size
+		size_type size{0};
+		// The largest required size
+		size_type high_water_mark{0};
+		// The largest required size since the requirement last exceeded a
+		// quarter of the allocation
+		size_type shrink_high_water_mark{0};
+		int requests_below_shrink_threshold{0};
+		std::size_t reallocations{0};
+		size_type allocated_size{0};
+	};
+
+	using entry_map = std::unordered_map<std::string, entry>;
+
+	static const size_type min_size{1 << 16};
+	static const int shrink_delay{120};
+
+	friend void swap( buffer_pool& lhs, buffer_pool& rhs )
+	{
+		using std::swap;
+		swap(lhs.entries, rhs.entries);
+	}
+
+	// Reallocates buffer if size does not fit or if the allocation has been
+	// much too large for long. The contents are lost on reallocation.
+	// Returns true if buffer was reallocated.
+	bool reserve( const std::string& name, const buffer& buffer, size_type size );
+	// Records that name requires size bytes and returns the size that its
+	// allocation should have; allocated_size to keep it. Makes no OpenGL
+	// calls.
+	size_type request( const std::string& name, size_type allocated_size, size_type size );
+
+	entry_map entries;
+
+
+
+protected:
+	static size_type round_up( size_type size );
+};
+
+
+
+inline std::ostream& operator<<( std::ostream& stream, const buffer_pool& pool )
+{
+	static const double megabyte{1.0e-6};
+	for (const auto& entry : pool.entries)
+		stream << entry.first << " [MB]: " << entry.second.size * megabyte
+			<< " (" << entry.second.high_water_mark * megabyte << " high-water, "
+			<< entry.second.allocated_size * megabyte << " allocated, "
+			<< entry.second.reallocations << " reallocations)\n";
+	return stream;
+}
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
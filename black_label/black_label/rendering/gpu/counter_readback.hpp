@@ -0,0 +1,71 @@
+#ifndef BLACK_LABEL_RENDERING_GPU_COUNTER_READBACK_HPP
+#define BLACK_LABEL_RENDERING_GPU_COUNTER_READBACK_HPP
+
+#include <black_label/rendering/gpu/buffer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Counter Readback
+///
+/// Reads a counter written by the GPU (e.g., an atomic counter) without
+/// waiting for the GPU. The counter is copied on the GPU into one of latency
+/// staging buffers and a fence is inserted. The value is read once the fence
+/// is signaled, i.e., a few frames later.
+///
+/// Not thread-safe; must be used by the OpenGL thread.
+////////////////////////////////////////////////////////////////////////////////
+class counter_readback
+{
+public:
+	static const int latency{3};
+
+	friend void swap( counter_readback& lhs, counter_readback& rhs )
+	{
+		using std::swap;
+		swap(lhs.slots, rhs.slots);
+		swap(lhs.next, rhs.next);
+	}
+
+	counter_readback() : next{0} {}
+	counter_readback( counter_readback&& other ) : counter_readback{} { swap(*this, other); }
+	counter_readback( const counter_readback& ) = delete;
+	~counter_readback();
+
+	counter_readback& operator=( counter_readback&& rhs ) { swap(*this, rhs); return *this; }
+	counter_readback& operator=( const counter_readback& ) = delete;
+
+	// Copies the first four bytes of counter
+	void copy( const buffer& counter );
+	// Gets the most recent copy that the GPU is done with. Returns false if
+	// there is none since the last call. Never blocks.
+	bool read( std::uint32_t& value );
+
+
+
+protected:
+	struct slot {
+		buffer staging;
+		// A GLsync
+		void* fence{nullptr};
+	};
+
+	std::array<slot, latency> slots;
+	int next;
+};
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef BLACK_LABEL_RENDERING_GPU_GEOMETRY_ARENA_HPP
+#define BLACK_LABEL_RENDERING_GPU_GEOMETRY_ARENA_HPP
+
+#include <black_label/rendering/gpu/buffer.hpp>
+#include <black_label/rendering/gpu/vertex_array.hpp>
+
+#include <memory>
+#include <vector>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+class geometry_arena;
+
+// The part of a geometry arena that holds the vertices and indices of a mesh.
+// The indices are relative to base_vertex. The space is released when the
+// last pointer to the range is destroyed.
+struct geometry_range
+{
+	geometry_arena* arena;
+	int base_vertex, vertex_count;
+	unsigned int first_index, index_count;
+};
+using geometry_range_pointer = std::shared_ptr<geometry_range>;
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Geometry Arena
+///
+/// Vertex and index buffers shared by all meshes of a vertex format such that
+/// the meshes are drawn with the same vertex array, e.g., by a single
+/// glMultiDrawElementsIndirect. Each attribute has its own buffer and a fixed
+/// location (0: positions, 1: normals, 2: texture coordinates). Meshes
+/// without indices are given trivial ones.
+///
+/// The arena grows geometrically. Released ranges are reclaimed when it grows.
+////////////////////////////////////////////////////////////////////////////////
+class geometry_arena
+{
+public:
+	// Bits of the vertex format
+	enum format_type { positions = 0, normals = 1, texture_coordinates = 2 };
+	static const int format_count{4};
+
+	explicit geometry_arena( int format );
+	geometry_arena( const geometry_arena& ) = delete;
+	geometry_arena& operator=( const geometry_arena& ) = delete;
+
+	static int get_format( const float* normals_begin, const float* texture_coordinates_begin )
+	{ return (normals_begin ? normals : 0) | (texture_coordinates_begin ? texture_coordinates : 0); }
+
+	// Not thread-safe; must be called by an OpenGL thread
+	geometry_range_pointer insert(
+		const float* vertices_begin,
+		const float* vertices_end,
+		const float* normals_begin = nullptr,
+		const float* texture_coordinates_begin = nullptr,
+		const unsigned int* indices_begin = nullptr,
+		const unsigned int* indices_end = nullptr );
+
+	void bind() const { vertex_array.bind(); }
+
+	// Bytes of GPU buffer memory
+	buffer::size_type size() const
+	{
+		return vertex_buffers[0].allocated_size + vertex_buffers[1].allocated_size
+			+ vertex_buffers[2].allocated_size + index_buffer.allocated_size;
+	}
+
+	// Bytes per vertex
+	buffer::size_type vertex_size() const;
+
+	int format;
+
+
+
+protected:
+	// Ensures room for the given number of additional vertices and indices
+	void reserve( int vertices, unsigned int indices );
+
+	buffer vertex_buffers[3], index_buffer;
+	gpu::vertex_array vertex_array;
+	int vertex_count, vertex_capacity;
+	unsigned int index_count, index_capacity;
+	std::vector<std::weak_ptr<geometry_range>> ranges;
+};
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Geometry Arenas
+///
+/// One arena per vertex format.
+////////////////////////////////////////////////////////////////////////////////
+class geometry_arenas
+{
+public:
+	geometry_arenas()
+	{ for (int format{0}; geometry_arena::format_count > format; ++format) arenas.emplace_back(new geometry_arena{format}); }
+
+	// Not thread-safe; must be called by an OpenGL thread
+	geometry_range_pointer insert(
+		const float* vertices_begin,
+		const float* vertices_end,
+		const float* normals_begin = nullptr,
+		const float* texture_coordinates_begin = nullptr,
+		const unsigned int* indices_begin = nullptr,
+		const unsigned int* indices_end = nullptr )
+	{
+		return arenas[geometry_arena::get_format(normals_begin, texture_coordinates_begin)]->insert(
+			vertices_begin, vertices_end, normals_begin, texture_coordinates_begin, indices_begin, indices_end);
+	}
+
+	// Bytes of GPU buffer memory
+	buffer::size_type size() const
+	{
+		buffer::size_type result{0};
+		for (const auto& arena : arenas) result += arena->size();
+		return result;
+	}
+
+	std::vector<std::unique_ptr<geometry_arena>> arenas;
+};
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
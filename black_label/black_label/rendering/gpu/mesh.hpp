@@ -7,6 +7,7 @@
 #include <black_label/rendering/program.hpp>
 #include <black_label/rendering/cpu/model.hpp>
 #include <black_label/rendering/gpu/argument/mesh.hpp>
+#include <black_label/rendering/gpu/geometry_arena.hpp>
 #include <black_label/rendering/gpu/texture.hpp>
 #include <black_label/rendering/gpu/vertex_array.hpp>
 #include <black_label/utility/threading_building_blocks/path.hpp>
@@ -26,6 +27,19 @@ namespace gpu {
 
 using texture_map = concurrent_resource_map<texture>;
 
+// Locations of the material uniforms set by mesh::render. Resolve once per 
+// program (e.g., per pass) instead of per draw.
+struct material_uniforms
+{
+	material_uniforms( const core_program& program )
+		: diffuse_texture{program.get_uniform_location("diffuse_texture")}
+		, specular_texture{program.get_uniform_location("specular_texture")}
+		, specular_exponent{program.get_uniform_location("specular_exponent")}
+	{}
+
+	unsigned int diffuse_texture, specular_texture, specular_exponent;
+};
+
 class mesh
 {
 public:
@@ -78,6 +92,7 @@ public:
 		swap(lhs.vertex_buffer, rhs.vertex_buffer);
 		swap(lhs.index_buffer, rhs.index_buffer);
 		swap(lhs.vertex_array, rhs.vertex_array);
+		swap(lhs.geometry, rhs.geometry);
 		swap(lhs.draw_mode, rhs.draw_mode);
 		swap(lhs.material, rhs.material);
 		swap(lhs.diffuse, rhs.diffuse);
@@ -95,12 +110,21 @@ public:
 	{ load(configuration); }
 	mesh( configuration configuration, texture_map& textures )
 		: mesh{configuration}
+	{ find_textures(textures); }
+	// The vertices and indices are stored in one of the arenas
+	mesh( configuration configuration, texture_map& textures, geometry_arenas& arenas )
+		: mesh{configuration.material, configuration.draw_mode}
 	{ 
-		texture_map::const_accessor texture;
-		if (textures.find(texture, material.diffuse_texture))
-			diffuse = texture->second.lock();
-		if (textures.find(texture, material.specular_texture))
-			specular = texture->second.lock();
+		using namespace std;
+		geometry = arenas.insert(
+			cbegin(configuration.vertices),
+			cend(configuration.vertices),
+			cbegin(configuration.normals),
+			cbegin(configuration.texture_coordinates),
+			cbegin(configuration.indices),
+			cend(configuration.indices));
+		draw_count = static_cast<int>(geometry->index_count);
+		find_textures(textures);
 	}
 	mesh( const mesh& ) = delete; // Possible, but do you really want to?
 	mesh( mesh&& other ) : mesh{} { swap(*this, other); }
@@ -125,20 +149,47 @@ public:
 			cend(configuration.indices));
 	}
 
-	bool is_loaded() const { return vertex_buffer.valid(); }
+	bool is_loaded() const { return vertex_buffer.valid() || geometry; }
 	bool has_indices() const { return index_buffer.valid(); }
 
-	void render( const core_program& program, unsigned int texture_unit ) const;
-	void render() const;
+	// Bytes of GPU buffer memory (the share of the arena if in one)
+	buffer::size_type size() const 
+	{
+		if (geometry) 
+			return geometry->vertex_count * geometry->arena->vertex_size()
+				+ geometry->index_count * static_cast<buffer::size_type>(sizeof(unsigned int));
+		return vertex_buffer.allocated_size + index_buffer.allocated_size; 
+	}
+
+	void use_material( const core_program& program, const material_uniforms& uniforms, unsigned int texture_unit ) const;
+
+	void render( const core_program& program, unsigned int texture_unit ) const
+	{ render(program, material_uniforms{program}, texture_unit); }
+	void render( const core_program& program, const material_uniforms& uniforms, unsigned int texture_unit, int instance_count = 1 ) const;
+	void render( int instance_count = 1 ) const;
 
 
 
 	int draw_count;
 	buffer vertex_buffer, index_buffer;
 	vertex_array vertex_array;
+	// Set instead of the buffers and vertex array if stored in an arena
+	geometry_range_pointer geometry;
 	draw_mode draw_mode;
 	material material;
 	std::shared_ptr<texture> diffuse, specular;
+
+
+
+protected:
+	void find_textures( texture_map& textures )
+	{
+		texture_map::const_accessor texture;
+		if (textures.find(texture, material.diffuse_texture))
+			diffuse = texture->second.lock();
+		if (textures.find(texture, material.specular_texture))
+			specular = texture->second.lock();
+	}
 };
 
 
@@ -4,8 +4,12 @@
 #include <black_label/rendering/gpu/mesh.hpp>
 #include <black_label/rendering/light.hpp>
 
+#include <limits>
+
 #include <boost/serialization/access.hpp>
 
+#include <glm/glm.hpp>
+
 
 
 namespace black_label {
@@ -26,6 +30,8 @@ public:
 		swap(lhs.meshes, rhs.meshes);
 		swap(lhs.lights, rhs.lights);
 		swap(lhs.checksum, rhs.checksum);
+		swap(lhs.lower_bound, rhs.lower_bound);
+		swap(lhs.upper_bound, rhs.upper_bound);
 	}
 
 	model() {}
@@ -36,26 +42,64 @@ public:
 	{
 		bool testing = std::is_rvalue_reference<T&&>::value;
 
+		set_bounds(cpu_model);
 		for (auto& cpu_mesh : std::forward<T>(cpu_model).meshes) 
 			meshes.emplace_back(utility::forward_as<T>(cpu_mesh), textures);
 	}
+	// The meshes are stored in the arenas
+	template<typename T>
+	model( T&& cpu_model, texture_map& textures, geometry_arenas& arenas ) 
+		: lights(std::forward<T>(cpu_model).lights)
+		, checksum{std::forward<T>(cpu_model).checksum}
+	{
+		set_bounds(cpu_model);
+		for (auto& cpu_mesh : std::forward<T>(cpu_model).meshes) 
+			meshes.emplace_back(utility::forward_as<T>(cpu_mesh), textures, arenas);
+	}
 	model( model&& other ) : model{} { swap(*this, other); }
 
 	model& operator=( model rhs ) { swap(*this, rhs); return *this; }
 
 	bool is_loaded() const { return !meshes.empty(); }
 	bool has_lights() const { return !lights.empty(); }
+	bool has_bounds() const { return lower_bound.x <= upper_bound.x; }
+
+	// Bytes of GPU buffer memory (excluding textures)
+	buffer::size_type size() const
+	{
+		buffer::size_type result{0};
+		for (const auto& mesh : meshes) result += mesh.size();
+		return result;
+	}
 
 	void render( const core_program& program, unsigned int texture_unit ) const
-	{ for (const auto& mesh : meshes) mesh.render(program, texture_unit); }
-	void render() const
-	{ for (const auto& mesh : meshes) mesh.render(); }
+	{ render(program, material_uniforms{program}, texture_unit); }
+	void render( const core_program& program, const material_uniforms& uniforms, unsigned int texture_unit, int instance_count = 1 ) const
+	{ for (const auto& mesh : meshes) mesh.render(program, uniforms, texture_unit, instance_count); }
+	void render( int instance_count = 1 ) const
+	{ for (const auto& mesh : meshes) mesh.render(instance_count); }
 
 
 
 	mesh_container meshes;
 	light_container lights;
 	utility::checksum checksum;
+	// Axis-aligned bounding box in object space. Empty (lower > upper) if 
+	// there are no vertices.
+	glm::vec3 lower_bound{std::numeric_limits<float>::max()}, upper_bound{-std::numeric_limits<float>::max()};
+
+
+
+protected:
+	void set_bounds( const cpu::model& cpu_model )
+	{
+		for (const auto& cpu_mesh : cpu_model.meshes)
+			for (std::size_t i{0}; cpu_mesh.vertices.size() >= i + 3; i += 3) {
+				glm::vec3 vertex{cpu_mesh.vertices[i], cpu_mesh.vertices[i + 1], cpu_mesh.vertices[i + 2]};
+				lower_bound = glm::min(lower_bound, vertex);
+				upper_bound = glm::max(upper_bound, vertex);
+			}
+	}
 };
 
 } // namespace gpu
@@ -0,0 +1,103 @@
+#ifndef BLACK_LABEL_RENDERING_GPU_STATE_CACHE_HPP
+#define BLACK_LABEL_RENDERING_GPU_STATE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+////////////////////////////////////////////////////////////////////////////////
+/// State Cache
+///
+/// A shadow copy of the OpenGL state that is set through the wrappers (pass,
+/// program, mesh, texture, framebuffer and vertex array). Calls that would not
+/// change the state are skipped and counted as elided.
+///
+/// Only state set through the cache is known. Call invalidate after OpenGL is
+/// used directly (e.g., by SFML). Deleted objects must be forgotten since
+/// their ids are reused.
+///
+/// Not thread-safe; must be used by the OpenGL thread.
+////////////////////////////////////////////////////////////////////////////////
+class state_cache
+{
+public:
+	using id_type = unsigned int;
+
+	struct counters {
+		std::size_t issued{0}, elided{0};
+	};
+
+	static state_cache& get();
+
+	// Forgets the context state. Uniform values are kept since they belong to
+	// the programs.
+	void invalidate();
+	// Moves the counters of the frame into last_frame
+	void end_frame() { last_frame = frame; frame = counters{}; }
+
+	void use_program( id_type program );
+	void bind_framebuffer( id_type framebuffer );
+	void bind_vertex_array( id_type vertex_array );
+	void active_texture( unsigned int texture_unit );
+	// Binds to the active texture unit
+	void bind_texture( unsigned int target, id_type texture );
+	void viewport( int x, int y, int width, int height );
+	// E.g., GL_BLEND, GL_DEPTH_TEST or GL_CULL_FACE
+	void set_capability( unsigned int capability, bool enabled );
+	void cull_face( unsigned int mode );
+	// Sets a sampler (or other integer) uniform of the program in use
+	void set_uniform( id_type program, unsigned int location, int value );
+
+	void forget_program( id_type program );
+	void forget_framebuffer( id_type framebuffer );
+	void forget_vertex_array( id_type vertex_array );
+	void forget_texture( id_type texture );
+
+	counters frame, last_frame;
+
+
+
+protected:
+	static const id_type unknown{~id_type{0}};
+
+	state_cache() { invalidate(); }
+
+	// Counts the call. Returns true if it should be issued.
+	bool issue( bool changed )
+	{
+		++(changed ? frame.issued : frame.elided);
+		return changed;
+	}
+
+	id_type program, framebuffer, vertex_array;
+	unsigned int texture_unit, cull_face_mode;
+	int viewport_x, viewport_y, viewport_width, viewport_height;
+	// Keyed by texture unit and target
+	std::unordered_map<std::uint64_t, id_type> textures;
+	std::unordered_map<unsigned int, bool> capabilities;
+	// Keyed by program and location
+	std::unordered_map<std::uint64_t, int> uniforms;
+};
+
+
+
+inline std::ostream& operator<<( std::ostream& stream, const state_cache::counters& counters )
+{
+	return stream << "state_changes: " << counters.issued << " issued, "
+		<< counters.elided << " elided\n";
+}
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
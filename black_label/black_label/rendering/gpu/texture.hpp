@@ -133,6 +133,9 @@ public:
 	void bind( target::type target ) const;
 	void set_parameters( target::type target, filter::type filter, wrap::type wrap ) const;
 	void use( target::type target, const core_program& program, const char* name, unsigned int& texture_unit ) const;
+	void use( target::type target, const core_program& program, unsigned int location, unsigned int& texture_unit ) const;
+	// Binds no texture to the texture unit of the sampler
+	static void use_none( target::type target, const core_program& program, unsigned int location, unsigned int& texture_unit );
 
 	void update(
 		target::type target,
@@ -206,6 +209,8 @@ public:
 	id_type id;
 
 protected:
+	static void use_texture( target::type target, const core_program& program, unsigned int location, unsigned int& texture_unit, id_type id );
+
 	void generate();
 };
 
@@ -217,6 +222,13 @@ protected:
 class texture : protected basic_texture
 {
 public:
+	using size_type = std::size_t;
+	using frame_type = std::uint64_t;
+
+	// Incremented once per frame by the owner of the textures. Used to find the
+	// least-recently-rendered textures.
+	static frame_type current_frame;
+
 	friend void swap( texture& lhs, texture& rhs )
 	{
 		using std::swap;
@@ -224,9 +236,12 @@ public:
 		swap(lhs.target, rhs.target);
 		swap(lhs.format, rhs.format);
 		swap(lhs.checksum, rhs.checksum);
+		swap(lhs.dimensions, rhs.dimensions);
+		swap(lhs.mipmap_levels, rhs.mipmap_levels);
+		swap(lhs.last_used_frame, rhs.last_used_frame);
 	}
 
-	texture() : basic_texture{} {};
+	texture() : basic_texture{}, mipmap_levels{0}, last_used_frame{0} {};
 	texture( texture&& other ) : texture{} { swap(*this, other); };
 	texture( 
 		target::type target, 
@@ -236,6 +251,9 @@ public:
 		: basic_texture{target, filter, wrap}
 		, target{target}
 		, format{format}
+		, dimensions{0, 0}
+		, mipmap_levels{0}
+		, last_used_frame{0}
 	{}
 	texture( 
 		target::type target,
@@ -251,6 +269,9 @@ public:
 		: basic_texture{target, format, filter, wrap, width, height, data_format, data_type, data, mipmap_levels}
 		, target{target}
 		, format{format}
+		, dimensions{width, height}
+		, mipmap_levels{mipmap_levels}
+		, last_used_frame{0}
 	{}
 	template<typename data_type>
 	texture( 
@@ -265,6 +286,9 @@ public:
 		: basic_texture{target, format, filter, wrap, width, height, data, mipmap_levels}
 		, target{target}
 		, format{format}
+		, dimensions{width, height}
+		, mipmap_levels{mipmap_levels}
+		, last_used_frame{0}
 	{}
 	texture( const cpu::texture& cpu_texture )
 		: basic_texture{
@@ -273,6 +297,9 @@ public:
 			wrap::repeat}
 		, target{target::texture_2d}
 		, checksum{cpu_texture.checksum}
+		, dimensions{cpu_texture.width, cpu_texture.height}
+		, mipmap_levels{8}
+		, last_used_frame{current_frame}
 	{
 		if (cpu_texture.compressed)
 		{
@@ -284,7 +311,7 @@ public:
 				cpu_texture.height,
 				static_cast<int>(cpu_texture.data.size()),
 				cpu_texture.data.data(),
-				8);
+				mipmap_levels);
 		}
 		else
 		{
@@ -297,7 +324,7 @@ public:
 				data_format::rgba,
 				data_type::uint8,
 				cpu_texture.data.data(),
-				8);
+				mipmap_levels);
 		}
 	}
 
@@ -307,13 +334,27 @@ public:
 	using basic_texture::valid;
 	bool has_depth_format() const
 	{ return format::is_depth_format(format); }
+	bool has_compressed_format() const
+	{ return format::compressed_srgb == format; }
+
+	// Bytes of GPU memory used by all mipmap levels
+	size_type size() const;
+	// Bytes of GPU memory all mipmap levels would use if stored as RGBA8
+	size_type uncompressed_size() const;
+
+	// Replaces the storage with one that lacks the most detailed mipmap level. 
+	// Returns false if there is no level to spare or if the driver lacks the 
+	// required extensions. Reloading the texture restores the dropped levels.
+	bool drop_mipmap_level();
 
 	void bind() const
 	{ basic_texture::bind(target); }
 	void set_parameters( filter::type filter, wrap::type wrap ) const
 	{ basic_texture::set_parameters(target, filter, wrap); }
 	void use( const core_program& program, const char* name, unsigned int& texture_unit ) const
-	{ basic_texture::use(target, program, name, texture_unit); }
+	{ last_used_frame = current_frame; basic_texture::use(target, program, name, texture_unit); }
+	void use( const core_program& program, unsigned int location, unsigned int& texture_unit ) const
+	{ last_used_frame = current_frame; basic_texture::use(target, program, location, texture_unit); }
 
 	void update(
 		int width, 
@@ -352,6 +393,10 @@ public:
 	target::type target;
 	format::type format;
 	utility::checksum checksum;
+	// Dimensions of the most detailed mipmap level
+	glm::ivec2 dimensions;
+	int mipmap_levels;
+	mutable frame_type last_used_frame;
 };
 
 
@@ -369,6 +414,7 @@ public:
 		swap(lhs.wrap, rhs.wrap);
 		swap(lhs.width, rhs.width);
 		swap(lhs.height, rhs.height);
+		swap(lhs.render_scale, rhs.render_scale);
 	}
 
 	storage_texture() {}
@@ -401,6 +447,9 @@ public:
 	filter::type filter;
 	wrap::type wrap;
 	float width, height;
+	// The fraction of each dimension that the last pass rendered to (see
+	// basic_pass::render_scale)
+	mutable glm::vec2 render_scale{1.0f};
 };
 
 
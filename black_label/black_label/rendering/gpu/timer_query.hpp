@@ -0,0 +1,83 @@
+#ifndef BLACK_LABEL_RENDERING_GPU_TIMER_QUERY_HPP
+#define BLACK_LABEL_RENDERING_GPU_TIMER_QUERY_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Timer Query
+///
+/// Measures the GPU time between begin and end with GL_TIMESTAMP queries. The
+/// queries of a frame are read back latency frames later, at which point the
+/// GPU is done with them, so measuring never stalls the CPU. Results that are
+/// still not available by then are dropped.
+///
+/// A timer may be begun and ended several times per frame (e.g., once per
+/// shadow map). gpu_time is the sum of the intervals of the most recent frame
+/// that has been read back.
+///
+/// Not thread-safe; must be used by the OpenGL thread.
+////////////////////////////////////////////////////////////////////////////////
+class timer_query
+{
+public:
+	using id_type = unsigned int;
+	static const int latency{3};
+
+	friend void swap( timer_query& lhs, timer_query& rhs )
+	{
+		using std::swap;
+		swap(lhs.frames, rhs.frames);
+		swap(lhs.gpu_time, rhs.gpu_time);
+	}
+
+	timer_query() : gpu_time{0} {}
+	timer_query( timer_query&& other ) : timer_query{} { swap(*this, other); }
+	timer_query( const timer_query& ) = delete;
+	~timer_query();
+
+	timer_query& operator=( timer_query&& rhs ) { swap(*this, rhs); return *this; }
+	timer_query& operator=( const timer_query& ) = delete;
+
+	// Advances all timers to the next frame. Called once per frame before any
+	// timer is begun.
+	static void next_frame() { ++current_frame; }
+
+	void begin() { record(); }
+	void end() { record(); }
+
+	static unsigned int current_frame;
+	std::chrono::nanoseconds gpu_time;
+
+
+
+protected:
+	struct frame {
+		unsigned int number{0};
+		// Pairs of begin and end timestamps
+		std::vector<id_type> queries;
+		std::size_t used{0};
+	};
+
+	void record();
+	// Reads back the queries of the frame if the GPU is done with them
+	void collect( frame& frame );
+
+	std::array<frame, latency> frames;
+};
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef BLACK_LABEL_RENDERING_INDIRECT_DRAWS_HPP
+#define BLACK_LABEL_RENDERING_INDIRECT_DRAWS_HPP
+
+#include <black_label/rendering/instance_batches.hpp>
+#include <black_label/rendering/sort_key.hpp>
+#include <black_label/rendering/gpu/buffer.hpp>
+#include <black_label/rendering/gpu/mesh.hpp>
+
+#include <vector>
+
+
+
+namespace black_label {
+namespace rendering {
+
+
+
+class visibility;
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Indirect Draws
+///
+/// One DrawElementsIndirectCommand per mesh of each instance batch and view.
+/// The commands of a view are sorted by geometry arena, draw mode and
+/// material (see sort_key) such that a pass is submitted with one
+/// glMultiDrawElementsIndirect per vertex format (or per vertex format and
+/// material if the pass uses materials). The CPU cost of a pass thus depends
+/// on the number of groups, not on the number of statics. Within a group, the
+/// commands of each view are sorted front to back.
+///
+/// The commands draw the visible instances (see visibility). The offset into
+/// visible_block of each command is stored in a shader storage buffer
+/// (draw_block). Shaders index it with draw_offset + gl_DrawIDARB.
+////////////////////////////////////////////////////////////////////////////////
+class indirect_draws
+{
+public:
+	// Matches DrawElementsIndirectCommand
+	struct command {
+		unsigned int count, instance_count, first_index;
+		int base_vertex;
+		unsigned int base_instance;
+	};
+	// Consecutive commands that share arena, draw mode and material. The same
+	// for all views.
+	struct group {
+		const gpu::geometry_arena* arena;
+		draw_mode::type draw_mode;
+		// Any mesh of the group. Supplies the material.
+		const gpu::mesh* material;
+		int first, count;
+
+		bool has_same_geometry( const group& other ) const
+		{ return arena == other.arena && draw_mode == other.draw_mode; }
+	};
+
+	indirect_draws();
+
+	// Requires ARB_multi_draw_indirect
+	static bool is_supported();
+
+	// Not thread-safe; must be called by an OpenGL thread
+	void update( const instance_batches& batches, const visibility& visibility );
+
+	// Leaves the arena of the last group bound. materials may be null.
+	void render(
+		const core_program& program,
+		unsigned int draw_offset_location,
+		const gpu::material_uniforms* materials,
+		unsigned int texture_unit,
+		int view_index ) const;
+
+	bool empty() const { return draws.empty(); }
+
+	// View-major; draws.size() commands per view
+	std::vector<command> commands;
+	// The offset into visible_block of each command
+	std::vector<int> draw_instance_offsets;
+	std::vector<group> groups;
+	gpu::buffer command_buffer, draw_buffer;
+
+
+
+protected:
+	struct draw {
+		const gpu::mesh* mesh;
+		int batch;
+		// The index into groups
+		int group;
+		sort_key key;
+	};
+
+	std::vector<draw> draws;
+	// Kept between updates to avoid allocations
+	std::vector<draw> sorted_draws, draw_sort_buffer;
+};
+
+
+
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
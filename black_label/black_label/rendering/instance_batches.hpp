@@ -0,0 +1,111 @@
+#ifndef BLACK_LABEL_RENDERING_INSTANCE_BATCHES_HPP
+#define BLACK_LABEL_RENDERING_INSTANCE_BATCHES_HPP
+
+#include <black_label/rendering/gpu/buffer.hpp>
+#include <black_label/rendering/gpu/model.hpp>
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <boost/range/adaptor/map.hpp>
+#include <boost/range/combine.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+
+
+
+namespace black_label {
+namespace rendering {
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Instance Batches
+///
+/// Groups the (model, matrix) pairs of the statics by model. The per-instance
+/// data of all batches is stored contiguously in a shader storage buffer
+/// (instance_block) so that each mesh of a batch is drawn with a single
+/// instanced draw call. Shaders index the buffer through the visible
+/// instances of the view (see visibility).
+///
+/// The batches are retained. They are only rebuilt (and uploaded) when the
+/// revision of the statics changes.
+////////////////////////////////////////////////////////////////////////////////
+class instance_batches
+{
+public:
+	// Matches instance_data in instance_data.glsl (std430 layout)
+	struct instance {
+		glm::mat4 model_matrix;
+		// The inverse transpose of the upper-left 3x3 part of model_matrix
+		glm::mat4 normal_matrix;
+	};
+	struct batch {
+		const gpu::model* model;
+		int offset, count;
+	};
+
+	instance_batches() 
+		: buffer{gpu::target::shader_storage, gpu::usage::static_draw}
+		, revision{0}
+		, statics_revision{~std::size_t{0}}
+	{}
+
+	// Not thread-safe; must be called by an OpenGL thread
+	template<typename entities_container>
+	void update( const entities_container& statics, std::size_t statics_revision ) {
+		using namespace std;
+		using namespace boost::adaptors;
+
+		if (this->statics_revision == statics_revision) return;
+		this->statics_revision = statics_revision;
+		++revision;
+
+		// Collect and group the pairs by model
+		pairs.clear();
+		for (const auto& entities : statics | map_values)
+			for (auto model_and_matrix : combine(get<2>(entities), get<1>(entities)))
+				pairs.emplace_back(get<0>(model_and_matrix).get(), &get<1>(model_and_matrix));
+		stable_sort(pairs.begin(), pairs.end(), [] ( const auto& lhs, const auto& rhs )
+			{ return lhs.first < rhs.first; });
+
+		instances.clear();
+		batches.clear();
+		for (const auto& pair : pairs) {
+			if (batches.empty() || batches.back().model != pair.first)
+				batches.push_back({pair.first, static_cast<int>(instances.size()), 0});
+			++batches.back().count;
+
+			const glm::mat4& model_matrix = *pair.second;
+			instances.push_back({model_matrix, glm::mat4(glm::inverseTranspose(glm::mat3(model_matrix)))});
+		}
+
+		if (!instances.empty())
+			buffer.bind_and_update(static_cast<gpu::buffer::size_type>(instances.size() * sizeof(instance)), instances.data());
+	}
+
+	std::vector<instance> instances;
+	std::vector<batch> batches;
+	gpu::buffer buffer;
+	// Changes whenever the batches are rebuilt
+	std::size_t revision;
+
+
+
+protected:
+	std::size_t statics_revision;
+	// Kept between updates to avoid allocations
+	std::vector<std::pair<const gpu::model*, const glm::mat4*>> pairs;
+};
+
+
+
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
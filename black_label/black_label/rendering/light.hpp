@@ -3,6 +3,7 @@
 #define BLACK_LABEL_RENDERING_LIGHT_HPP
 
 #include <black_label/rendering/view.hpp>
+#include <black_label/rendering/gpu/buffer.hpp>
 #include <black_label/rendering/gpu/texture.hpp>
 #include <black_label/utility/serialization/glm.hpp>
 
@@ -34,9 +35,13 @@ public:
 		swap(lhs.color, rhs.color);
 		swap(lhs.shadow_map, rhs.shadow_map);
 		swap(lhs.view, rhs.view);
+		swap(lhs.uniform_block_offset, rhs.uniform_block_offset);
 	}
 
-	light() {}
+	// Size of the light_block uniform block (std140 layout)
+	static const gpu::buffer::size_type uniform_block_size{148};
+
+	light() : uniform_block_offset{0} {}
 	light( 
 		light_type type,
 		glm::vec3 position, 
@@ -46,8 +51,9 @@ public:
 		, position{position}
 		, direction{direction}
 		, color{color}
+		, uniform_block_offset{0}
 	{}
-	light( light&& other ) { swap(*this, other); }
+	light( light&& other ) : light{} { swap(*this, other); }
 	light& operator=( light rhs ) { swap(*this, rhs); return *this; }
 
 	template<typename T>
@@ -62,6 +68,9 @@ public:
 	glm::vec4 color;
 	gpu::storage_texture shadow_map;
 	view view;
+	// Offset of this light's light_block within the light buffer. Only 
+	// meaningful for shadow-casting lights.
+	gpu::buffer::offset_type uniform_block_offset;
 };
 
 } // namespace rendering
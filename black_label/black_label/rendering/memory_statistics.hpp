@@ -0,0 +1,71 @@
+#ifndef BLACK_LABEL_RENDERING_MEMORY_STATISTICS_HPP
+#define BLACK_LABEL_RENDERING_MEMORY_STATISTICS_HPP
+
+#include <cstddef>
+#include <ostream>
+
+
+
+namespace black_label {
+namespace rendering {
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Memory Statistics
+///
+/// Byte counts of the memory held by the rendering assets. CPU staging
+/// refers to imported models and textures that await upload to the GPU.
+////////////////////////////////////////////////////////////////////////////////
+class memory_statistics
+{
+public:
+	using size_type = std::size_t;
+
+	size_type gpu_total() const { return gpu_buffers + gpu_textures; }
+	size_type total() const { return cpu_staging + gpu_total(); }
+
+	size_type
+		cpu_staging{0},
+		gpu_buffers{0},
+		gpu_textures{0},
+		// What gpu_textures would be if all textures were uncompressed
+		gpu_textures_uncompressed{0},
+		// The share of gpu_textures that is compressed
+		gpu_textures_compressed{0};
+	std::size_t model_count{0}, texture_count{0};
+	// Entries of the model and texture maps. Expired entries await a sweep.
+	std::size_t
+		live_model_entries{0}, 
+		expired_model_entries{0}, 
+		live_texture_entries{0}, 
+		expired_texture_entries{0};
+};
+
+
+
+inline std::ostream& operator<<( std::ostream& stream, const memory_statistics& statistics )
+{
+	static const double megabyte{1.0e-6};
+	return stream
+		<< "cpu_staging [MB]: " << statistics.cpu_staging * megabyte << "\n"
+		<< "gpu_buffers [MB]: " << statistics.gpu_buffers * megabyte
+			<< " (" << statistics.model_count << " models)\n"
+		<< "gpu_textures [MB]: " << statistics.gpu_textures * megabyte
+			<< " (" << statistics.texture_count << " textures, "
+			<< statistics.gpu_textures_compressed * megabyte << " compressed, "
+			<< statistics.gpu_textures_uncompressed * megabyte << " if uncompressed)\n"
+		<< "model_entries: " << statistics.live_model_entries << " live, " 
+			<< statistics.expired_model_entries << " expired\n"
+		<< "texture_entries: " << statistics.live_texture_entries << " live, " 
+			<< statistics.expired_texture_entries << " expired\n";
+}
+
+
+
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
@@ -6,14 +6,20 @@
 #include <black_label/rendering/gpu/model.hpp>
 #include <black_label/rendering/gpu/framebuffer.hpp>
 #include <black_label/rendering/gpu/texture.hpp>
+#include <black_label/rendering/gpu/timer_query.hpp>
 #include <black_label/rendering/light_grid.hpp>
 #include <black_label/rendering/program.hpp>
 #include <black_label/rendering/screen_aligned_quad.hpp>
+#include <black_label/rendering/visibility.hpp>
 #include <black_label/utility/algorithm.hpp>
 #include <black_label/world/entities.hpp>
 
+#include <algorithm>
 #include <bitset>
+#include <cassert>
 #include <chrono>
+#include <string>
+#include <unordered_map>
 
 #include <boost/range/adaptor/indirected.hpp>
 #include <boost/range/algorithm/find_if.hpp>
@@ -80,9 +86,12 @@ public:
 			width = view.window.x;
 			height = view.window.y;
 		} else {
+			// Only the lower left part of the outputs is rendered to if scaled
 			const gpu::storage_texture& first_texture = *std::cbegin(output_textures);
-			width = static_cast<int>(view.window.x * first_texture.width);
-			height = static_cast<int>(view.window.y * first_texture.height);
+			width = std::max(1, static_cast<int>(view.window.x * first_texture.width * render_scale));
+			height = std::max(1, static_cast<int>(view.window.y * first_texture.height * render_scale));
+			for (const gpu::storage_texture& texture : output_textures)
+				texture.render_scale = glm::vec2{width, height} / glm::vec2{texture.dimensions};
 		}
 		
 		set_viewport(width, height);
@@ -107,44 +116,125 @@ public:
 
 	static void wait_for_opengl();
 
+	// Adds to render_time and timer so that they may span several views
 	template<typename assets_type, typename range>
 	void render( 
 		gpu::framebuffer& framebuffer, 
 		const assets_type& assets, 
+		const visibility& visibility,
 		const view& view,
 		const range& output_textures ) const
 	{
 		auto start_time = std::chrono::high_resolution_clock::now();
-		unsigned int texture_unit{0};
+		timer.begin();
+		unsigned int texture_unit{0}, shader_storage_binding_point{0};
 		program->use();
-		render(framebuffer, assets, view, output_textures, texture_unit);
-//#ifdef _DEBUG
-		wait_for_opengl();
-//#endif
-		render_time = std::chrono::high_resolution_clock::now() - start_time;
+		render(framebuffer, assets, visibility, view, output_textures, texture_unit, shader_storage_binding_point);
+		timer.end();
+		if (synchronous) wait_for_opengl();
+		render_time += std::chrono::high_resolution_clock::now() - start_time;
+	}
+
+	// Indirect path. Taken if supported and the program reads per-draw data. 
+	// Returns false if not taken.
+	template<typename assets_type>
+	bool render_statics_indirect( 
+		const assets_type& assets, 
+		const visibility& visibility, 
+		int view_index, 
+		const view& view, 
+		unsigned int shader_storage_binding_point, 
+		unsigned int texture_unit ) const 
+	{
+		auto instance_block = program->get_resource_index(interface::shader_storage_block, "instance_block");
+		auto draw_block = program->get_resource_index(interface::shader_storage_block, "draw_block");
+		// The instance counts of the commands are not multiplied by layer_count
+		if (!indirect_draws::is_supported()
+			|| core_program::invalid_location == instance_block 
+			|| core_program::invalid_location == draw_block
+			|| 1 < layer_count)
+			return false;
+
+		const auto& draws = visibility.draws;
+		if (draws.empty()) return true;
+
+		program->set_shader_storage_block(instance_block, shader_storage_binding_point, assets.static_instances.buffer);
+		program->set_shader_storage_block("visible_block", shader_storage_binding_point, visibility.buffer);
+		program->set_shader_storage_block(draw_block, shader_storage_binding_point, draws.draw_buffer);
+		program->set_uniform("view_matrix", view.view_matrix);
+		program->set_uniform("view_projection_matrix", view.view_projection_matrix);
+		program->set_uniform("indirect", 1);
+
+		if (render_mode[render_mode::materials]) {
+			gpu::material_uniforms uniforms{*program};
+			draws.render(*program, program->get_uniform_location("draw_offset"), &uniforms, texture_unit, view_index);
+		}
+		else
+			draws.render(*program, program->get_uniform_location("draw_offset"), nullptr, texture_unit, view_index);
+		return true;
 	}
 
+	// Draws the instances that are visible in view front to back
 	template<typename assets_type, typename callable>
-	void render_statics( const assets_type& assets, const view& view, callable render ) const {
-		using namespace std;
-		using namespace boost::adaptors;
+	void render_statics( 
+		const assets_type& assets, 
+		const visibility& visibility, 
+		int view_index, 
+		const view& view, 
+		unsigned int shader_storage_binding_point, 
+		callable render ) const 
+	{
+		const auto& instance_batches = assets.static_instances;
+		auto ranges = visibility.get_ranges(view_index);
+		auto order = visibility.get_order(view_index);
+
+		// Instanced path. Taken if the program reads per-instance data.
+		auto instance_block = program->get_resource_index(interface::shader_storage_block, "instance_block");
+		if (core_program::invalid_location != instance_block) {
+			if (instance_batches.batches.empty()) return;
+
+			program->set_shader_storage_block(instance_block, shader_storage_binding_point, instance_batches.buffer);
+			program->set_shader_storage_block("visible_block", shader_storage_binding_point, visibility.buffer);
+			program->set_uniform("view_matrix", view.view_matrix);
+			program->set_uniform("view_projection_matrix", view.view_projection_matrix);
+			program->set_uniform("indirect", 0);
+			auto instance_offset = program->get_uniform_location("instance_offset");
+			auto layer_instance_count = program->get_uniform_location("layer_instance_count");
+
+			for (std::size_t i{0}; instance_batches.batches.size() > i; ++i) {
+				auto batch = order[i];
+				if (0 == ranges[batch].count) continue;
+				program->set_uniform(instance_offset, ranges[batch].offset);
+				program->set_uniform(layer_instance_count, ranges[batch].count);
+				render(*instance_batches.batches[batch].model, ranges[batch].count * layer_count);
+			}
+			return;
+		}
 
-		for (auto entities : assets.statics | map_values) {
-			for (auto model_and_matrix : combine(get<assets_type::model_container>(entities), get<assets_type::transformation_range>(entities))) {
-				const auto& model = get<0>(model_and_matrix);
-				const auto& model_matrix = get<1>(model_and_matrix);
+		// Resolved once per pass so that the per-draw path does no lookups
+		auto normal_matrix = program->get_uniform_location("normal_matrix");
+		auto model_matrix_location = program->get_uniform_location("model_matrix");
+		auto model_view_matrix = program->get_uniform_location("model_view_matrix");
+		auto model_view_projection_matrix = program->get_uniform_location("model_view_projection_matrix");
+
+		for (std::size_t i{0}; instance_batches.batches.size() > i; ++i) {
+			auto batch = order[i];
+			const auto& range = ranges[batch];
+			for (auto visible_instance = range.offset; range.offset + range.count > visible_instance; ++visible_instance) {
+				const auto& instance = instance_batches.instances[visibility.visible_instances[visible_instance]];
+				const auto& model_matrix = instance.model_matrix;
 
 				// Uniforms
-				program->set_uniform("normal_matrix", 
-					glm::inverseTranspose(glm::mat3(model_matrix)));
-				program->set_uniform("model_matrix", 
+				program->set_uniform(normal_matrix, 
+					glm::mat3(instance.normal_matrix));
+				program->set_uniform(model_matrix_location, 
 					model_matrix);
-				program->set_uniform("model_view_matrix", 
+				program->set_uniform(model_view_matrix, 
 					view.view_matrix * model_matrix);
-				program->set_uniform("model_view_projection_matrix", 
+				program->set_uniform(model_view_projection_matrix, 
 					view.view_projection_matrix * model_matrix);
 
-				render(*model);
+				render(*instance_batches.batches[batch].model, 1);
 			}
 		}
 	}
@@ -160,7 +250,21 @@ public:
 	std::shared_ptr<program> program;
 	unsigned int clearing_mask, face_culling_mode;
 	render_mode render_mode;
+	// The statics are drawn once per layer in the same draws. The layer of an
+	// instance is gl_InstanceID / layer_instance_count. Requires the instanced
+	// path.
+	int layer_count{1};
+	// The CPU time spent submitting the pass. Includes the GPU time if
+	// synchronous.
 	mutable std::chrono::high_resolution_clock::duration render_time;
+	// The GPU time of the pass (read back a few frames late)
+	mutable gpu::timer_query timer;
+	// The fraction of each dimension of the outputs that is rendered to. Set
+	// by the frame_time_governor for scalable passes.
+	mutable float render_scale{1.0f};
+
+	// Debug mode. Waits for OpenGL (and checks for errors) after each pass.
+	static bool synchronous;
 
 
 
@@ -169,9 +273,11 @@ protected:
 	void render( 
 		gpu::framebuffer& framebuffer, 
 		const assets_type& assets,
+		const visibility& visibility,
 		const view& view,
 		const range& output_textures,
-		unsigned int& texture_unit ) const
+		unsigned int& texture_unit,
+		unsigned int& shader_storage_binding_point ) const
 	{
 		set_viewport(view, output_textures);
 		set_blend_mode();
@@ -182,11 +288,16 @@ protected:
 			return;
 		}
 		set_clearing_mask();
-		if (render_mode[render_mode::statics]) {
+		auto view_index = visibility.find(view);
+		// The pipeline culls all views of the passes that draw statics
+		assert(visibility::invalid_view_index != view_index || !render_mode[render_mode::statics]);
+		if (render_mode[render_mode::statics] && visibility::invalid_view_index != view_index
+			&& !render_statics_indirect(assets, visibility, view_index, view, shader_storage_binding_point, texture_unit)) {
 			if (render_mode[render_mode::materials])
-				render_statics(assets, view, [this, texture_unit] ( const auto& model ) mutable { model.render(*program, texture_unit); });
+				render_statics(assets, visibility, view_index, view, shader_storage_binding_point, [this, texture_unit, uniforms = gpu::material_uniforms{*program}] ( const auto& model, int instance_count ) mutable 
+					{ model.render(*program, uniforms, texture_unit, instance_count); });
 			else
-				render_statics(assets, view, [] ( const auto& model ) { model.render(); });
+				render_statics(assets, visibility, view_index, view, shader_storage_binding_point, [] ( const auto& model, int instance_count ) { model.render(instance_count); });
 		}
 		if (render_mode[render_mode::screen_aligned_quad]) render_screen_aligned_quad(view);
 	}
@@ -222,7 +333,8 @@ public:
 		const black_label::rendering::view* user_view,
 		int preincrement_buffer_counter = 0,
 		int ldm_view_count = 0,
-		std::shared_ptr<std::vector<glm::uvec4>> data_offsets = nullptr ) 
+		std::shared_ptr<std::vector<glm::uvec4>> data_offsets = nullptr,
+		unsigned int data_offset = 0 ) 
 		: basic_pass{
 			std::move(name),
 			std::move(program), 
@@ -240,8 +352,56 @@ public:
 		, preincrement_buffer_counter{preincrement_buffer_counter}
 		, ldm_view_count{ldm_view_count}
 		, data_offsets{data_offsets}
+		, data_offset{data_offset}
 	{}
 
+	// Matches view_type in view_type.glsl (std140 and std430 layout)
+	struct view_data {
+		glm::mat4 view_matrix, projection_matrix, view_projection_matrix;
+		glm::vec4 eye;
+		glm::vec4 right, forward, up;
+		glm::ivec2 dimensions;
+		glm::vec2 padding;
+	};
+	// The CPU-side data of a frame. Built by record, possibly on a worker 
+	// thread, and replayed to OpenGL by render.
+	struct recording_type {
+		std::vector<float> lights;
+		int light_count;
+		view_data current_view, user_view;
+		std::vector<view_data> auxiliary_views;
+		glm::mat4 inverse_view_projection_matrix;
+	};
+
+	// Thread-safe if the lights and views are not changed meanwhile; makes no 
+	// OpenGL calls
+	template<typename light_container>
+	void record( const light_container& lights ) const {
+		recording.lights.clear();
+		recording.light_count = 0;
+		for (const light& light : lights)
+		{
+			++recording.light_count;
+			recording.lights.insert(recording.lights.end(), {
+				light.position.x, light.position.y, light.position.z,
+				light.color.r, light.color.g, light.color.b});
+		}
+
+		recording.current_view = make_view_data(*view);
+		recording.user_view = make_view_data(*user_view);
+		recording.auxiliary_views.clear();
+		for (const auto& entry : auxiliary_views)
+			recording.auxiliary_views.push_back(make_view_data(*entry.second));
+		recording.inverse_view_projection_matrix = glm::inverse(view->view_projection_matrix);
+	}
+
+	// The name of the pipeline texture that the shaders know as name
+	const std::string& texture_name( const std::string& name ) const {
+		auto result = texture_names.find(name);
+		return (texture_names.cend() == result) ? name : result->second;
+	}
+
+	// Also sets <name>_scale to the render scale of each (see render_scale.glsl)
 	void set_input_textures( unsigned int& texture_unit ) const;
 	void set_buffers( unsigned int& shader_storage_binding_point, unsigned int& uniform_binding_point ) const;
 	void set_uniforms() const;
@@ -255,32 +415,21 @@ public:
 		using namespace std;
 		using namespace gpu;
 
-		static vector<float> test_lights;
-		test_lights.clear();
 		int shadow_map_index{0};
-		int light_count{0};
-
 		for (const light& light : lights)
 		{
-			++light_count;
-			test_lights.push_back(light.position.x);
-			test_lights.push_back(light.position.y);
-			test_lights.push_back(light.position.z);
-			test_lights.push_back(light.color.r);
-			test_lights.push_back(light.color.g);
-			test_lights.push_back(light.color.b);
-
 			if (!light.shadow_map) continue;
 
 			auto name = "shadow_map_" + to_string(shadow_map_index++);
 			light.shadow_map.use(*program, name.c_str(), texture_unit);
-			program->set_uniform_block("light_block", uniform_binding_point, light_buffer);
+			program->set_uniform_block("light_block", uniform_binding_point, light_buffer, 
+				light.uniform_block_offset, gpu::buffer::size_type{light::uniform_block_size});
 		}
 
 		static texture_buffer gpu_lights{usage::stream_draw, format::r32f};
 
-		if (!test_lights.empty())
-			gpu_lights.bind_buffer_and_update(test_lights.size(), test_lights.data());
+		if (!recording.lights.empty())
+			gpu_lights.bind_buffer_and_update(recording.lights.size(), recording.lights.data());
 		else
 			gpu_lights.bind_buffer_and_update<float>(1);
 
@@ -288,12 +437,15 @@ public:
 
 
 #ifndef USE_TILED_SHADING
-		program->set_uniform("lights_size", light_count);
+		program->set_uniform("lights_size", recording.light_count);
 #endif
 	}
 	void set_auxiliary_views( unsigned int& shader_storage_binding_point, unsigned int& uniform_binding_point ) const;
 	void set_memory_barrier() const;
 
+	bool is_scalable() const
+	{ return min_render_scale < max_render_scale; }
+
 
 	
 	void render_photons( 
@@ -303,9 +455,11 @@ public:
 
 
 	template<typename assets_type>
-	void render( gpu::framebuffer& framebuffer, const assets_type& assets ) const {
+	// Requires that record was called this frame
+	void render( gpu::framebuffer& framebuffer, const assets_type& assets, const visibility& visibility ) const {
 		using namespace boost::adaptors;
 		auto start_time = std::chrono::high_resolution_clock::now();
+		timer.begin();
 		unsigned int 
 			texture_unit{0}, 
 			uniform_binding_point{0}, 
@@ -325,17 +479,22 @@ public:
 			basic_pass::render(
 				framebuffer, 
 				assets, 
+				visibility,
 				*view, 
 				output_textures | map_values | indirected,
-				texture_unit);
+				texture_unit,
+				shader_storage_binding_point);
 		set_memory_barrier();
-//#ifdef _DEBUG
-		wait_for_opengl();
-//#endif
+		timer.end();
+		if (synchronous) wait_for_opengl();
 		render_time = std::chrono::high_resolution_clock::now() - start_time;
 	}
 
 	texture_container input_textures, output_textures;
+	// The names of the pipeline textures by the names that the shaders use
+	// where they differ, e.g., for the resampled textures of a pass with a
+	// resolution; see texture_name
+	std::unordered_map<std::string, std::string> texture_names;
 	view_container auxiliary_views;
 	buffer_container buffers;
 	index_bound_buffer_container index_bound_buffers;
@@ -343,8 +502,20 @@ public:
 	const black_label::rendering::view
 		* view,
 		* user_view;
+	// If not 0, the counter is set to this before the pass
 	int preincrement_buffer_counter, ldm_view_count;
+	// The offsets of the heads of each layered depth map in data_buffer
 	std::shared_ptr<std::vector<glm::uvec4>> data_offsets;
+	// The offset of the heads of the layered depth map drawn by the pass
+	unsigned int data_offset;
+	// The bounds of render_scale. Scalable if they differ.
+	float min_render_scale{1.0f}, max_render_scale{1.0f};
+	mutable recording_type recording;
+
+
+
+protected:
+	static view_data make_view_data( const black_label::rendering::view& view );
 };
 
 
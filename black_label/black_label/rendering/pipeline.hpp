@@ -1,16 +1,25 @@
 #ifndef BLACK_LABEL_RENDERING_PIPELINE_HPP
 #define BLACK_LABEL_RENDERING_PIPELINE_HPP
 
+#include <black_label/rendering/frame_time_governor.hpp>
 #include <black_label/rendering/light.hpp>
 #include <black_label/rendering/pass.hpp>
+#include <black_label/rendering/render_graph.hpp>
+#include <black_label/rendering/gpu/buffer_pool.hpp>
+#include <black_label/rendering/gpu/counter_readback.hpp>
+#include <black_label/rendering/gpu/state_cache.hpp>
 #include <black_label/utility/threading_building_blocks/path.hpp>
 
+#include <algorithm>
 #include <unordered_map>
 
 #include <boost/algorithm/cxx11/all_of.hpp>
+#include <boost/algorithm/cxx11/any_of.hpp>
 #include <boost/range/adaptor/filtered.hpp>
 
 #include <tbb/concurrent_unordered_map.h>
+#include <tbb/parallel_for_each.h>
+#include <tbb/task_group.h>
 
 // TODO: Remove. Just for debugging
 #include <GL/glew.h>
@@ -26,7 +35,7 @@ class pipeline
 {
 public:
 	using pass_container = std::vector<pass>;
-	using program_map = concurrent_resource_map<program>;
+	using program_map = std::unordered_multimap<path, std::weak_ptr<program>>;
 	using view_map = resource_map<view>;
 	using texture_map = resource_map<gpu::storage_texture>;
 	using buffer_map = resource_map<gpu::buffer>;
@@ -40,15 +49,23 @@ public:
 		swap(lhs.user_view, rhs.user_view);
 		swap(lhs.shader_directory, rhs.shader_directory);
 		swap(lhs.programs, rhs.programs);
+		swap(lhs.program_cache, rhs.program_cache);
+		swap(lhs.unreported_programs, rhs.unreported_programs);
 		swap(lhs.views, rhs.views);
 		swap(lhs.textures, rhs.textures);
 		swap(lhs.buffers, rhs.buffers);
 		swap(lhs.index_bound_buffers, rhs.index_bound_buffers);
 		swap(lhs.buffers_to_reset_pre_first_frame, rhs.buffers_to_reset_pre_first_frame);
 		swap(lhs.passes, rhs.passes);
+		swap(lhs.graph, rhs.graph);
+		swap(lhs.governor, rhs.governor);
+		swap(lhs.buffer_pool, rhs.buffer_pool);
 		swap(lhs.shadow_mapping, rhs.shadow_mapping);
 		swap(lhs.ldm_view_count, rhs.ldm_view_count);
 		swap(lhs.data_offsets, rhs.data_offsets);
+		swap(lhs.visibility, rhs.visibility);
+		swap(lhs.data_counter, rhs.data_counter);
+		swap(lhs.photon_counter, rhs.photon_counter);
 	}
 
 	pipeline( const black_label::rendering::view* user_view = nullptr, path shader_directory = path{} )
@@ -62,11 +79,18 @@ public:
 	pipeline( pipeline&& other ) : pipeline{} { swap(*this, other); };
 	pipeline& operator=( pipeline rhs ) { swap(*this, rhs); return *this; }
 
+	// False, without waiting, while programs are pending
 	bool is_complete() const {
 		return complete && shadow_mapping.program->is_complete()
 			&& boost::algorithm::all_of(programs | boost::adaptors::map_values, 
 			[] ( const auto& program ) { return program.lock()->is_complete(); });
 	}
+	// True while the driver still compiles or links programs in the background
+	bool is_pending() const {
+		return complete && ((shadow_mapping.program && shadow_mapping.program->is_pending())
+			|| boost::algorithm::any_of(programs | boost::adaptors::map_values, 
+			[] ( const auto& program ) { return program.lock()->is_pending(); }));
+	}
 	bool import( path pipeline_file );
 	bool reload( path file ) {
 		if (!try_canonical_and_preferred(file, shader_directory))
@@ -84,12 +108,41 @@ public:
 		return false;
 	}
 
+	// Culls the statics against the views of the shadow maps and of the passes
+	// that draw statics
+	template<typename assets_type>
+	void update_visibility( const assets_type& assets ) {
+		using namespace std;
+
+		vector<const view*> views;
+		for (const light& light : assets.shadow_casting_lights)
+			views.push_back(&light.view);
+		for (render_graph::index_type index{0}; passes.size() > index; ++index) {
+			const auto& pass = passes[index];
+			if (!graph.is_culled(index) && pass.render_mode[render_mode::statics] && pass.view
+				&& views.cend() == find(views.cbegin(), views.cend(), pass.view))
+				views.push_back(pass.view);
+		}
+
+		visibility.update(assets.static_instances, move(views));
+	}
+
+	// Builds the CPU-side data of the passes in parallel. The OpenGL thread
+	// only replays it in render_passes.
+	template<typename assets_type>
+	void record( const assets_type& assets ) const {
+		tbb::parallel_for_each(passes.cbegin(), passes.cend(), [&assets] ( const pass& pass )
+			{ pass.record(assets.lights); });
+	}
+
 	template<typename assets_type>
 	void render_shadow_maps( gpu::framebuffer& framebuffer, const assets_type& assets ) const {
+		shadow_mapping.render_time = std::chrono::high_resolution_clock::duration::zero();
 		for (const light& light : assets.shadow_casting_lights)
 			shadow_mapping.render(
 				framebuffer, 
 				assets, 
+				visibility,
 				light.view, 
 				utility::make_range(light.shadow_map));
 	}
@@ -99,53 +152,52 @@ public:
 	void render_passes( gpu::framebuffer& framebuffer, const assets_type& assets )
 	//{ for (const auto& pass : passes) pass.render(framebuffer, assets); }
 	{ 
-		for (auto& pass : passes) pass.render(framebuffer, assets);
+		for (render_graph::index_type index{0}; passes.size() > index; ++index)
+			if (!graph.is_culled(index)) passes[index].render(framebuffer, assets, visibility);
 
+		// The buffers are sized from counts of earlier frames such that no pass
+		// waits for the GPU
 		if (auto count_buffer = index_bound_buffers["counter"].lock()) {
-			// Get the number of link nodes
+			data_counter.copy(*count_buffer);
+
+			// Enough space for the heads and link nodes
 			uint32_t count;
-			count_buffer->bind();
-			glGetBufferSubData(count_buffer->target, 0, sizeof(uint32_t), &count);
-
-			// Allocate enough space for the link nodes
-			auto& data_buffer = *buffers["data_buffer"].lock();
-			data_buffer_size = (count + data_offsets->back()[0]) * (4 + 4);
-
-			data_buffer.bind();
-			int32_t old_data_buffer_size;
-			glGetBufferParameteriv(data_buffer.target, GL_BUFFER_SIZE, &old_data_buffer_size);
-			if (old_data_buffer_size != data_buffer_size)
-				data_buffer.update(data_buffer_size);
+			auto buffer = buffers["data_buffer"].lock();
+			if (buffer && data_counter.read(count))
+				buffer_pool.reserve("data_buffer", *buffer, count * (4 + 4));
 		}
 
 		if (auto count_buffer = index_bound_buffers["photon_counter"].lock()) {
-			// Get the number of photons
+			photon_counter.copy(*count_buffer);
+
+			// Enough space for the photons
 			uint32_t count;
-			count_buffer->bind();
-			glGetBufferSubData(count_buffer->target, 0, sizeof(uint32_t), &count);
-
-			// Allocate enough space for the photons
-			auto& photon_buffer = *buffers["photon_buffer"].lock();
-			photon_buffer_size = count * (5 * 4 * sizeof(float));
-
-			photon_buffer.bind();
-			int32_t old_photon_buffer_size;
-			glGetBufferParameteriv(photon_buffer.target, GL_BUFFER_SIZE, &old_photon_buffer_size);
-			if (old_photon_buffer_size != photon_buffer_size)
-				photon_buffer.update(photon_buffer_size);
+			auto buffer = buffers["photon_buffer"].lock();
+			if (buffer && photon_counter.read(count))
+				buffer_pool.reserve("photon_buffer", *buffer, count * (5 * 4 * sizeof(float)));
 		}
 	}
-			
+
 	template<typename assets_type>
 	//void render( gpu::framebuffer& framebuffer, const assets_type& assets ) const {
 	void render( gpu::framebuffer& framebuffer, const assets_type& assets ) {
+		report_programs();
 		if (!is_complete()) return;
 		auto start_time = std::chrono::high_resolution_clock::now();
+		gpu::timer_query::next_frame();
+		timer.begin();
 		reset(buffers_to_reset_pre_first_frame);
+		tbb::task_group recording;
+		recording.run([this, &assets] { record(assets); });
+		update_visibility(assets);
 		render_shadow_maps(framebuffer, assets);
+		recording.wait();
 		render_passes(framebuffer, assets);
-		pass::wait_for_opengl();
+		timer.end();
+		governor.update(timer.gpu_time, passes, graph);
+		if (pass::synchronous) pass::wait_for_opengl();
 		render_time = std::chrono::high_resolution_clock::now() - start_time;
+		gpu::state_cache::get().end_frame();
 	}
 
 	template<typename range>
@@ -164,10 +216,20 @@ public:
 	void on_window_resized( int width, int height ) {
 		for (auto& texture : textures) {
 			if ("random" == texture.first) continue;
+			// Only used by culled passes
+			if (!graph.lifetimes.count(texture.first)) continue;
+			// Resized through the texture whose allocation it uses
+			if (graph.aliases.count(texture.first)) continue;
 
 			auto locked_texture = texture.second.lock();
 			if (!locked_texture) continue;
 
+			// Already allocated, e.g., if kept by import
+			glm::ivec2 dimensions{
+				static_cast<int>(locked_texture->width * width),
+				static_cast<int>(locked_texture->height * height)};
+			if (dimensions == locked_texture->dimensions) continue;
+
 			*locked_texture = gpu::storage_texture(
 				*locked_texture,
 				width,
@@ -180,25 +242,49 @@ public:
 	bool complete;
 	const view* user_view;
 	path shader_directory;
+	// By file. A program is listed under each of its shader files and the
+	// files that they include.
 	program_map programs;
+	// By configuration; see add_program
+	std::unordered_map<std::string, std::weak_ptr<program>> program_cache;
+	// Programs that were compiled but not yet waited for; see report_programs
+	std::vector<std::weak_ptr<program>> unreported_programs;
 	view_map views;
 	texture_map textures;
 	buffer_map buffers;
 	index_bound_buffer_map index_bound_buffers;
 	reset_container buffers_to_reset_pre_first_frame;
 	pass_container passes;
+	render_graph graph;
+	// Scales the scalable passes; see import
+	frame_time_governor governor;
+	// Sizes data_buffer and photon_buffer from the counters
+	gpu::buffer_pool buffer_pool;
 	basic_pass shadow_mapping;
+	// See basic_pass
 	mutable std::chrono::high_resolution_clock::duration render_time;
-	uint32_t data_buffer_size, photon_buffer_size;
+	mutable gpu::timer_query timer;
 	int ldm_view_count{0};
 	std::shared_ptr<std::vector<glm::uvec4>> data_offsets;
+	// Rebuilt by calling render
+	black_label::rendering::visibility visibility;
+	// Delayed copies of counter and photon_counter
+	gpu::counter_readback data_counter, photon_counter;
 
 
 
 private:
 	void reload_shadow_mapping();
+	// Makes the aliased textures of the passes share their allocations
+	void alias_textures();
 	bool reload_program( path program_file );
+	// Lists the program under the files that it does not already list under
+	void associate_files( const std::shared_ptr<program>& program_ );
+	// Does not wait for the compiler
 	std::shared_ptr<program> add_program( program::configuration configuration );
+	// Logs the info logs of the programs that are no longer pending and
+	// stores their binaries
+	void report_programs();
 };
 
 
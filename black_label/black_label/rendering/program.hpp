@@ -8,7 +8,10 @@
 
 #include <array>
 #include <bitset>
+#include <cstdint>
 #include <iterator>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -20,6 +23,11 @@ namespace rendering {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Shader
+///
+/// The shader file may include other files with #include "file" where file is
+/// relative to the including file. Each file is included at most once. The
+/// source string number in the info log is 2 for the shader file itself and
+/// 3 + i for dependencies[i].
 ////////////////////////////////////////////////////////////////////////////////
 class shader
 {
@@ -42,44 +50,75 @@ public:
 		using std::swap;
 		swap(rhs.id, lhs.id);
 		swap(rhs.status, lhs.status);
+		swap(rhs.is_compile_status_queried, lhs.is_compile_status_queried);
 		swap(rhs.type, lhs.type);
 		swap(rhs.preprocessor_commands, lhs.preprocessor_commands);
 		swap(rhs.path_to_shader, lhs.path_to_shader);
+		swap(rhs.source, lhs.source);
+		swap(rhs.source_hash, lhs.source_hash);
+		swap(rhs.dependencies, lhs.dependencies);
 	}
-	shader() : id(invalid_id) {}
-	shader( shader&& other ) : id(invalid_id) { swap(*this, other); }
+	shader() : id(invalid_id), is_compile_status_queried(true), source_hash(0) {}
+	shader( shader&& other ) : id(invalid_id), is_compile_status_queried(true), source_hash(0) { swap(*this, other); }
+	// Always preprocessed but only compiled if compile_now is true
 	shader( 
 		shader_type type, 
 		const path& path_to_shader, 
-		const std::string& preprocessor_commands = std::string() );
+		const std::string& preprocessor_commands = std::string(),
+		bool compile_now = true );
 	BLACK_LABEL_SHARED_LIBRARY ~shader();
 
 	shader& operator =( shader lhs ) { swap(*this, lhs); return *this; }
 
-	void load();
+	void load() { preprocess(); compile(); }
+	// Reads the shader file and expands its includes
+	void preprocess();
+	// Does nothing if the shader file was not found
+	void compile();
+
+	// Whether file is the shader file or one of its dependencies
+	bool depends_on( const path& file ) const;
 
 	bool is_tried_instantiated() const
 	{ return status.test(is_tried_instantiated_bit); }
+	// Waits for the compiler unless is_pending is false
 	bool is_compiled() const
-	{ return status.test(compile_status_bit); };
+	{ query_compile_status(); return status.test(compile_status_bit); };
 	bool is_shader_file_found() const
 	{ return status.test(shader_file_found_bit); };
+	// Waits for the compiler unless is_pending is false
 	bool is_complete() const
-	{ return status.all(); };
+	{ query_compile_status(); return status.all(); };
+	// True while the driver still compiles the shader in the background. Always
+	// false without KHR_parallel_shader_compile.
+	bool is_pending() const;
 
 	std::string get_info_log() const;
 
 	id_type id;
-	status_type status;
+	// The compile status bit is only valid after query_compile_status
+	mutable status_type status;
 
 	shader_type type;
 	std::string preprocessor_commands;
 	path path_to_shader;
+	// The preprocessed source code and a hash of it, the preprocessor commands
+	// and the numerical constants. Shaders with equal hashes compile alike.
+	std::string source;
+	std::uint64_t source_hash;
+	// The included files
+	std::vector<path> dependencies;
 
 
 
 protected:
 	shader( const shader& other );
+
+	// Compilation is asynchronous; the status is only queried once it is
+	// needed such that all shaders may be compiled before any is waited for
+	void query_compile_status() const;
+
+	mutable bool is_compile_status_queried;
 };
 
 
@@ -102,14 +141,27 @@ class core_program
 public:
 	typedef unsigned int id_type;
 	const static id_type invalid_id = 0;
+	// Returned for names that are not active in the program
+	const static unsigned int invalid_location = static_cast<unsigned int>(-1);
+
+	struct uniform_info {
+		unsigned int location, type;
+		int size;
+	};
+	using uniform_map = std::unordered_map<std::string, uniform_info>;
+	using index_map = std::unordered_map<std::string, unsigned int>;
 
 	friend void swap( core_program& rhs, core_program& lhs )
 	{
 		using std::swap;
 		swap(rhs.id, lhs.id);
+		swap(rhs.uniforms, lhs.uniforms);
+		swap(rhs.uniform_blocks, lhs.uniform_blocks);
+		swap(rhs.shader_storage_blocks, lhs.shader_storage_blocks);
+		swap(rhs.is_reflected, lhs.is_reflected);
 	}
-	core_program() : id(invalid_id) {}
-	core_program( core_program&& other ) : id(invalid_id) { swap(*this, other); }
+	core_program() : id(invalid_id), is_reflected(true) {}
+	core_program( core_program&& other ) : id(invalid_id), is_reflected(true) { swap(*this, other); }
 	core_program( generate_type );
 	~core_program();
 
@@ -118,8 +170,23 @@ public:
 	void use() const;
 	void set_output_location( unsigned int location, const std::string& name );
 	void set_attribute_location( unsigned int location, const std::string& name );
-	void link() const;
-
+	// Does not wait for the linker. The reflection cache is rebuilt by the
+	// first lookup.
+	void link();
+	// Links from a binary of get_binary. Returns false if the driver rejects
+	// the binary (e.g., after a driver update). Also rebuilds the reflection
+	// cache.
+	bool link( unsigned int binary_format, const std::vector<char>& binary );
+	// Returns false if the driver provides no binary
+	bool get_binary( unsigned int& binary_format, std::vector<char>& binary ) const;
+	// True while the driver still links the program in the background. Always
+	// false without KHR_parallel_shader_compile.
+	bool is_pending() const;
+
+	// Cached lookups (no driver queries). Locations and indices stay valid until 
+	// the program is linked again so they may be resolved once and reused, e.g., 
+	// for every draw of a pass.
+	const uniform_info* find_uniform( const std::string& name ) const;
 	unsigned int get_uniform_location( const std::string& name ) const;
 	unsigned int get_uniform_block_index( const std::string& name ) const;
 	unsigned int get_resource_index( interface::type interface, const std::string& name ) const;
@@ -153,6 +220,12 @@ public:
 		return -1 != index;
 	}
 	void set_uniform_block( unsigned int index, unsigned int& binding_point, const gpu::buffer& value ) const;
+	void set_uniform_block( 
+		unsigned int index, 
+		unsigned int& binding_point, 
+		const gpu::buffer& value, 
+		gpu::buffer::offset_type offset, 
+		gpu::buffer::size_type size ) const;
 
 	template<typename... T>
 	bool set_shader_storage_block( const std::string& name, unsigned int& binding_point, T&&... values ) const
@@ -165,12 +238,20 @@ public:
 	void set_shader_storage_block( unsigned int index, unsigned int& binding_point, const gpu::buffer& value ) const;
 
 	id_type id;
+	// Reflection cache. Rebuilt by the first lookup after link.
+	mutable uniform_map uniforms;
+	mutable index_map uniform_blocks, shader_storage_blocks;
 
 
 
 protected:
 	core_program( const core_program& other );
 
+	// Waits for the linker
+	void reflect() const;
+
+	mutable bool is_reflected;
+
 	unsigned int get_uniform_location_checked( const std::string& name ) const;
 };
 
@@ -249,47 +330,61 @@ public:
 		swap(rhs.vertex, lhs.vertex);
 		swap(rhs.geometry, lhs.geometry);
 		swap(rhs.fragment, lhs.fragment);
+		swap(rhs.binary_path, lhs.binary_path);
 	}
 	program() {}
 	program( const program& ) = delete;
 	program( program&& other ) : program{} { swap(*this, other); }
 
-	program( const configuration& configuration )
-		: core_program{black_label::rendering::generate}
-	{
-		setup(
-			configuration.path_to_vertex_shader_, 
-			configuration.path_to_geometry_shader_, 
-			configuration.path_to_fragment_shader_, 
-			configuration.preprocessor_commands_);
-		set_output_locations(
-			configuration.fragment_output_names_.cbegin(),
-			configuration.fragment_output_names_.cend());
-		set_attribute_locations(
-			configuration.vertex_attribute_names_.cbegin(),
-			configuration.vertex_attribute_names_.cend());
-		link();
-	}
+	// Loaded from the binary cache if possible; otherwise compiled and linked
+	program( const configuration& configuration );
 
 	BLACK_LABEL_SHARED_LIBRARY ~program();
 
 	program& operator=( program rhs ) { swap(*this, rhs); return *this; }
 
+	// False, without waiting, while the program is pending
 	bool is_complete() const;
+	// Recompiles the shaders that depend on program_file and relinks
 	void reload( path program_file );
+	// The shader files and their dependencies
+	std::vector<path> get_files() const;
+	// Stores the binary of a compiled program once it is linked. Waits for the
+	// linker unless is_pending is false.
+	void update_binary_cache();
 	std::string get_info_log() const;
 	std::string get_aggregated_info_log() const;
 
 	shader vertex, geometry, fragment;
 
+	// Where linked programs are cached by get_binary_path. Caching is disabled
+	// if empty.
+	static path binary_cache_directory;
+
 
 
 protected:
+	// The cache file of the preprocessed shaders and the configuration. Empty
+	// if caching is disabled or if a shader file is missing.
+	path get_binary_path( const configuration& configuration ) const;
+	bool load_binary( const path& binary_path );
+	void store_binary( const path& binary_path ) const;
+	// Replaces the shader with a newly compiled one unless the preprocessed
+	// source is unchanged. Returns whether it was replaced.
+	bool reload( shader& shader_ );
+	// Compiles and attaches the shaders that are preprocessed but not compiled
+	void compile_shaders();
+
+	// Where update_binary_cache stores the binary. Empty if there is nothing
+	// to store.
+	path binary_path;
+
 	void setup(
 		const path& path_to_vertex_shader,
 		const path& path_to_geometry_shader = path(),
 		const path& path_to_fragment_shader = path(),
-		const std::string& preprocessor_commands = std::string());
+		const std::string& preprocessor_commands = std::string(),
+		bool compile = true);
 
 	template<typename iterator>
 	void set_output_locations(
@@ -0,0 +1,85 @@
+#ifndef BLACK_LABEL_RENDERING_RENDER_GRAPH_HPP
+#define BLACK_LABEL_RENDERING_RENDER_GRAPH_HPP
+
+#include <black_label/rendering/pass.hpp>
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+
+namespace black_label {
+namespace rendering {
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Render Graph
+///
+/// The passes of a pipeline compiled into a DAG. A pass depends on the
+/// earlier passes that write the textures that it reads. Buffers may be both
+/// read and written by any pass, so a pass also depends on the last earlier
+/// pass that uses each of its buffers. Unless a pass clears its outputs, it
+/// also depends on their earlier writers since it may blend or depth test
+/// against their contents. The passes still execute in declaration order,
+/// which is a topological order of the DAG.
+///
+/// Passes that draw to the default framebuffer or use buffers (which may be
+/// read by the application, e.g., the counters) are live. So are the passes
+/// that a live pass depends on. All other passes are culled; nothing that
+/// they write reaches the screen.
+///
+/// Each texture gets a lifetime from the first to the last live pass that
+/// uses it. Textures that only culled passes use get no lifetime.
+/// A texture is transient if it is first used as an output of a pass that
+/// clears it or covers it with a screen-aligned quad, i.e., nothing in it
+/// outlives a frame. Transient textures that are allocated alike (same
+/// format, filter, wrap and relative size) and whose lifetimes are disjoint
+/// share one allocation; see aliases.
+////////////////////////////////////////////////////////////////////////////////
+class render_graph
+{
+public:
+	using index_type = std::size_t;
+
+	// Indices of the first and last pass that use a texture
+	struct lifetime {
+		index_type first, last;
+		bool transient;
+	};
+
+	render_graph() {}
+	explicit render_graph( const std::vector<pass>& passes );
+
+	bool is_culled( index_type index ) const
+	{ return culled[index]; }
+
+	// Per pass, the indices of the earlier passes that it depends on
+	std::vector<std::vector<index_type>> dependencies;
+	// Per pass
+	std::vector<bool> culled;
+	// By the names of the pipeline textures; see pass::texture_name
+	std::unordered_map<std::string, lifetime> lifetimes;
+	// Maps the name of an aliased texture to the name of the texture whose
+	// allocation it uses. Textures with their own allocation are not listed.
+	std::unordered_map<std::string, std::string> aliases;
+
+
+
+protected:
+	void compute_dependencies( const std::vector<pass>& passes );
+	void compute_culled( const std::vector<pass>& passes );
+	void compute_lifetimes( const std::vector<pass>& passes );
+	void compute_aliases( const std::vector<pass>& passes );
+};
+
+
+
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef BLACK_LABEL_RENDERING_SORT_KEY_HPP
+#define BLACK_LABEL_RENDERING_SORT_KEY_HPP
+
+#include <cstdint>
+#include <cstring>
+
+
+
+namespace black_label {
+namespace rendering {
+
+////////////////////////////////////////////////////////////////////////////////
+/// Sort Key
+///
+/// 64-bit keys that order draws first by the state they require and then by
+/// view depth. The draws are first sorted by their state key. From the most
+/// significant bit:
+///
+///  [63, 62] The vertex format (selects the geometry arena and thus the VAO)
+///  [61, 58] The draw mode
+///  [57, 42] The diffuse texture
+///  [41, 32] The specular texture
+///  [31,  0] Zero
+///
+/// Textures are given by the lower bits of their ids. Distinct states may
+/// thus share a key, so the sorted draws are grouped by comparing the states
+/// themselves. Each view then sorts its draws once by their sort key:
+///
+///  [63, 32] The index of the group in state key order
+///  [31,  0] The view depth (front to back)
+///
+/// The groups keep their order and ranges in every view.
+////////////////////////////////////////////////////////////////////////////////
+using sort_key = std::uint64_t;
+
+inline sort_key make_state_key( int format, unsigned int draw_mode, unsigned int diffuse, unsigned int specular )
+{
+	return (sort_key{static_cast<unsigned int>(format) & 0x3u} << 62)
+		| (sort_key{draw_mode & 0xfu} << 58)
+		| (sort_key{diffuse & 0xffffu} << 42)
+		| (sort_key{specular & 0x3ffu} << 32);
+}
+
+// Non-negative floats order as their bit patterns. Depths behind the eye are
+// clamped to 0.
+inline std::uint32_t make_depth_key( float depth )
+{
+	if (!(0.0f < depth)) return 0;
+	std::uint32_t result;
+	std::memcpy(&result, &depth, sizeof(result));
+	return result;
+}
+
+inline sort_key make_sort_key( std::uint32_t group, std::uint32_t depth_key )
+{ return (sort_key{group} << 32) | depth_key; }
+
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef BLACK_LABEL_RENDERING_VISIBILITY_HPP
+#define BLACK_LABEL_RENDERING_VISIBILITY_HPP
+
+#include <black_label/rendering/indirect_draws.hpp>
+#include <black_label/rendering/instance_batches.hpp>
+#include <black_label/rendering/view.hpp>
+#include <black_label/rendering/gpu/buffer.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+
+
+namespace black_label {
+namespace rendering {
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Visibility
+///
+/// Frustum culls the instances of the statics against all views of a frame in
+/// one sweep. The world-space bounding box of each instance is tested against
+/// the planes of every view (four planes at a time with SSE), which yields a
+/// mask of the views that the instance is visible in.
+///
+/// For each view, the indices of the visible instances of each batch are
+/// stored contiguously in a shader storage buffer (visible_block). Shaders
+/// read instances[visible_instances[instance_offset + gl_InstanceID]] so
+/// that a pass only draws what is visible in its view.
+///
+/// The visible instances of a batch are sorted front to back by the depth of
+/// their centers in the view. So are the batches themselves (see orders) by
+/// their nearest visible instance. Both are sorted with a radix sort.
+///
+/// Views beyond max_culled_view_count are not culled.
+///
+/// The result is retained. Nothing is culled, sorted or uploaded unless the
+/// batches, the views or their matrices changed since the last update.
+////////////////////////////////////////////////////////////////////////////////
+class visibility
+{
+public:
+	using mask_type = std::uint64_t;
+	static const int max_culled_view_count{64};
+	static const int invalid_view_index{-1};
+
+	// The visible instances of a batch in a view
+	struct range {
+		int offset, count;
+		// Of the nearest visible instance (see make_depth_key)
+		std::uint32_t depth_key;
+	};
+
+	visibility() : buffer{gpu::target::shader_storage, gpu::usage::stream_draw} {}
+
+	// Not thread-safe; must be called by an OpenGL thread
+	void update( const instance_batches& batches, std::vector<const view*> views );
+
+	int find( const view& view ) const
+	{
+		auto result = std::find(views.cbegin(), views.cend(), &view);
+		return (views.cend() != result) ? static_cast<int>(result - views.cbegin()) : invalid_view_index;
+	}
+
+	// One range per batch
+	const range* get_ranges( int view_index ) const
+	{ return ranges.data() + view_index * batch_count; }
+
+	// The batches front to back; batch_count per view
+	const int* get_order( int view_index ) const
+	{ return orders.data() + view_index * batch_count; }
+
+	std::vector<const view*> views;
+	// Per instance
+	std::vector<mask_type> masks;
+	std::vector<int> visible_instances;
+	// View-major; batch_count ranges per view
+	std::vector<range> ranges;
+	std::vector<int> orders;
+	// The world-space center of each instance
+	std::vector<glm::vec3> centers;
+	int batch_count{0};
+	gpu::buffer buffer;
+	// The indirect draws of the visible instances of each view
+	indirect_draws draws;
+
+
+
+protected:
+	struct keyed_index {
+		std::uint32_t key;
+		int index;
+	};
+
+	void cull( const instance_batches& batches );
+	// Returns true if nothing changed since the last update
+	bool is_current( const instance_batches& batches, const std::vector<const view*>& views ) const;
+
+	struct view_state { glm::mat4 view_matrix, view_projection_matrix; };
+	std::size_t batches_revision{~std::size_t{0}};
+	std::vector<view_state> view_states;
+
+	// Kept between updates to avoid allocations
+	std::vector<keyed_index> keyed, keyed_buffer;
+};
+
+
+
+} // namespace rendering
+} // namespace black_label
+
+
+
+#endif
@@ -3,8 +3,11 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <iterator>
 #include <random>
+#include <type_traits>
+#include <vector>
 
 
 
@@ -134,6 +137,52 @@ void generate_poisson_disc_samples( Iterator first, Iterator last )
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Radix Sort
+///
+/// Stable least significant digit radix sort of values by key(value), which
+/// must return an unsigned integer. One byte is sorted per pass; bytes that
+/// are the same for all values are skipped. buffer is scratch space that the
+/// caller may keep to avoid allocations.
+////////////////////////////////////////////////////////////////////////////////
+template<typename T, typename key_function>
+void radix_sort( std::vector<T>& values, std::vector<T>& buffer, key_function key )
+{
+	using key_type = std::decay_t<decltype(key(values.front()))>;
+	static_assert(std::is_unsigned<key_type>::value, "The key must be an unsigned integer.");
+	static const int digit_count{sizeof(key_type)};
+
+	if (2 > values.size()) return;
+
+	// Histograms of all digits in one sweep
+	std::array<std::array<std::size_t, 256>, digit_count> counts{};
+	for (const auto& value : values) {
+		auto value_key = key(value);
+		for (int digit{0}; digit_count > digit; ++digit)
+			++counts[digit][(value_key >> (8 * digit)) & 0xff];
+	}
+
+	buffer.resize(values.size());
+	for (int digit{0}; digit_count > digit; ++digit) {
+		auto& count = counts[digit];
+		if (values.size() == count[(key(values.front()) >> (8 * digit)) & 0xff]) continue;
+
+		// Exclusive prefix sum
+		std::size_t offset{0};
+		for (auto& bucket : count) {
+			auto size = bucket;
+			bucket = offset;
+			offset += size;
+		}
+
+		for (auto& value : values)
+			buffer[count[(key(value) >> (8 * digit)) & 0xff]++] = std::move(value);
+		values.swap(buffer);
+	}
+}
+
+
+
 } // namespace utility
 } // namespace black_label
 
@@ -0,0 +1,241 @@
+#ifndef BLACK_LABEL_UTILITY_CACHE_ARCHIVE_HPP
+#define BLACK_LABEL_UTILITY_CACHE_ARCHIVE_HPP
+
+#include <black_label/file_buffer.hpp>
+#include <black_label/path.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/log/trivial.hpp>
+
+
+
+namespace black_label {
+namespace utility {
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// Cache Archive
+///
+/// Packs the cache files of a directory into a single memory-mapped file.
+/// Layout:
+///   header
+///   entry[header.entry_count] (sorted by path)
+///   path characters
+///   blobs (each aligned to a page boundary)
+///
+/// The paths are relative to the archived directory and use generic ('/')
+/// separators. A blob holds the exact contents of a .cache file so the
+/// checksum header still decides whether it is outdated.
+////////////////////////////////////////////////////////////////////////////////
+class cache_archive
+{
+public:
+	struct blob { const char* data; std::size_t size; };
+
+	static const char* default_file_name() { return "assets.cache_archive"; }
+
+
+
+	friend void swap( cache_archive& lhs, cache_archive& rhs )
+	{
+		using std::swap;
+		swap(lhs.directory, rhs.directory);
+		swap(lhs.file, rhs.file);
+		swap(lhs.entries, rhs.entries);
+		swap(lhs.entry_count, rhs.entry_count);
+	}
+
+	cache_archive() : entries{nullptr}, entry_count{0} {}
+	cache_archive( cache_archive&& other ) : cache_archive{} { swap(*this, other); }
+	cache_archive& operator=( cache_archive rhs ) { swap(*this, rhs); return *this; }
+	// The directory of the archive is the directory that was packed
+	explicit cache_archive( const path& archive ) : cache_archive{} { open(archive); }
+
+
+
+	bool open( const path& archive )
+	{
+		*this = cache_archive{};
+		if (!is_regular_file(archive)) return false;
+
+		try { file.open(archive.string()); }
+		catch (const std::exception& exception)
+		{
+			BOOST_LOG_TRIVIAL(warning) << exception.what();
+			return false;
+		}
+
+		header header;
+		if (sizeof(header) > file.size()) return close();
+		std::memcpy(&header, file.data(), sizeof(header));
+		if (0 != std::memcmp(header.magic, magic(), sizeof(header.magic)) || version != header.version
+			|| sizeof(header) + header.entry_count * sizeof(entry) > file.size())
+			return close();
+
+		entries = reinterpret_cast<const entry*>(file.data() + sizeof(header));
+		entry_count = header.entry_count;
+
+		// A truncated or corrupt archive must not make find read outside of it
+		for (auto entry = entries; entries + entry_count != entry; ++entry)
+			if (!fits(entry->path_offset, entry->path_size) || !fits(entry->blob_offset, entry->blob_size)) {
+				BOOST_LOG_TRIVIAL(warning) << "Cache archive " << archive << " is corrupt; ignoring it";
+				return close();
+			}
+
+		directory = archive.parent_path();
+
+		BOOST_LOG_TRIVIAL(info) << "Opened cache archive " << archive << " (" << entry_count << " entries)";
+		return true;
+	}
+
+	bool is_open() const { return file.is_open(); }
+
+	// Thread-safe. The blob is valid while the archive is open.
+	bool find( const path& cache_file, blob& result ) const
+	{
+		if (!is_open()) return false;
+
+		std::string key;
+		if (!make_key(directory, cache_file, key)) return false;
+
+		auto entry = std::lower_bound(entries, entries + entry_count, key, [this] ( const cache_archive::entry& entry, const std::string& key )
+			{ return 0 > compare(get_path(entry), entry.path_size, key); });
+		if (entries + entry_count == entry || 0 != compare(get_path(*entry), entry->path_size, key))
+			return false;
+
+		result = {file.data() + entry->blob_offset, static_cast<std::size_t>(entry->blob_size)};
+		return true;
+	}
+
+	// Packs all .cache files found recursively in directory
+	static bool pack( const path& directory, const path& archive )
+	{
+		using namespace std;
+		using namespace boost::filesystem;
+
+		vector<pair<string, path>> files;
+		for (recursive_directory_iterator it{directory}, end; end != it; ++it) {
+			if (!is_regular_file(it->path()) || ".cache" != it->path().extension()) continue;
+			string key;
+			if (make_key(directory, it->path(), key)) files.emplace_back(move(key), it->path());
+		}
+		sort(files.begin(), files.end());
+
+		ofstream stream{archive.string(), ofstream::binary};
+		if (!stream.is_open()) return false;
+
+		header header;
+		memcpy(header.magic, magic(), sizeof(header.magic));
+		header.version = version;
+		header.entry_count = static_cast<std::uint32_t>(files.size());
+
+		// Index
+		vector<entry> index(files.size());
+		std::uint64_t offset{sizeof(header) + index.size() * sizeof(entry)};
+		for (std::size_t i{0}; files.size() > i; ++i) {
+			index[i].path_offset = offset;
+			index[i].path_size = files[i].first.size();
+			offset += files[i].first.size();
+		}
+		for (std::size_t i{0}; files.size() > i; ++i) {
+			offset = align(offset);
+			index[i].blob_offset = offset;
+			index[i].blob_size = file_size(files[i].second);
+			offset += index[i].blob_size;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(entry));
+		for (const auto& file : files) stream.write(file.first.data(), file.first.size());
+
+		// Blobs
+		for (std::size_t i{0}; files.size() > i; ++i) {
+			file_buffer::file_buffer blob{files[i].second.string()};
+			if (blob.size() != index[i].blob_size) return false;
+			pad(stream, index[i].blob_offset);
+			stream.write(blob.data(), blob.size());
+		}
+
+		BOOST_LOG_TRIVIAL(info) << "Packed " << files.size() << " cache files into " << archive;
+		return stream.good();
+	}
+
+
+
+	path directory;
+
+
+
+protected:
+	static const std::uint32_t version{1};
+	// Blobs start on page boundaries
+	static const std::uint64_t alignment{4096};
+
+	struct header {
+		char magic[4];
+		std::uint32_t version, entry_count, reserved;
+	};
+	struct entry {
+		std::uint64_t path_offset, path_size, blob_offset, blob_size;
+	};
+
+	static const char* magic() { return "BLCA"; }
+	static std::uint64_t align( std::uint64_t offset )
+	{ return (offset + alignment - 1) / alignment * alignment; }
+	static void pad( std::ofstream& stream, std::uint64_t offset )
+	{
+		auto position = static_cast<std::uint64_t>(stream.tellp());
+		if (offset > position) stream.write(std::string(offset - position, '\0').data(), offset - position);
+	}
+	static int compare( const char* lhs, std::uint64_t lhs_size, const std::string& rhs )
+	{
+		auto size = std::min<std::uint64_t>(lhs_size, rhs.size());
+		auto result = std::memcmp(lhs, rhs.data(), size);
+		if (0 != result) return result;
+		return (lhs_size < rhs.size()) ? -1 : (lhs_size > rhs.size()) ? 1 : 0;
+	}
+
+	// Strips the directory from file. Fails if file is not within directory.
+	static bool make_key( const path& directory, const path& file, std::string& key )
+	{
+		auto directory_it = directory.begin(), file_it = file.begin();
+		for (; directory.end() != directory_it; ++directory_it, ++file_it)
+			if (file.end() == file_it || *directory_it != *file_it) return false;
+
+		path relative;
+		for (; file.end() != file_it; ++file_it) relative /= *file_it;
+		if (".cache" != relative.extension()) relative += ".cache";
+		key = relative.generic_string();
+		return !relative.empty();
+	}
+
+	// Whether [offset, offset + size) is within the file. Does not overflow.
+	bool fits( std::uint64_t offset, std::uint64_t size ) const
+	{ return offset <= file.size() && size <= file.size() - offset; }
+	// Valid for all entries of an open archive; see open
+	const char* get_path( const entry& entry ) const { return file.data() + entry.path_offset; }
+
+	bool close() { *this = cache_archive{}; return false; }
+
+	boost::iostreams::mapped_file_source file;
+	const entry* entries;
+	std::uint32_t entry_count;
+};
+
+
+
+} // namespace utility
+} // namespace black_label
+
+
+
+#endif
@@ -1,12 +1,16 @@
 #ifndef BLACK_LABEL_UTILITY_CACHE_FILE_HPP
 #define BLACK_LABEL_UTILITY_CACHE_FILE_HPP
 
+#include <black_label/utility/cache_archive.hpp>
 #include <black_label/utility/checksum.hpp>
 #include <black_label/path.hpp>
 
 #include <fstream>
 #include <utility>
 
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
 #include <boost/log/trivial.hpp>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
@@ -30,6 +34,7 @@ public:
 
 	cache_file() {}
 	cache_file( path path ) : checksum(std::move(path)) {}
+	cache_file( const file_buffer::file_buffer& source ) : checksum{source} {}
 	cache_file( cache_file&& other ) { swap(*this, other); }
 	cache_file& operator=( cache_file rhs ) { swap(*this, rhs); return *this; }
 
@@ -38,32 +43,22 @@ public:
 	void apply_extension( path& path )
 	{ if (".cache" != path.extension()) path += ".cache"; }
 
+	// Tries the archive (if any) before the loose cache file
 	template<typename derived>
-	bool import( path path, derived& derived )
+	bool import( path path, derived& derived, const cache_archive* archive = nullptr )
 	{
 		apply_extension(path);
 
-		std::ifstream file{path.string(), std::ifstream::binary};
-		if (!file.is_open()) return false;
-	
-		BOOST_LOG_TRIVIAL(info) << "Importing cache file " << path;
-
-		if (utility::checksum{file, from_binary_header} != checksum)
-		{
-			BOOST_LOG_TRIVIAL(info) << "Cache file is outdated " << path;
-			return false;
-		}
-
-		file.seekg(0);
-		try { boost::archive::binary_iarchive{file} >> derived; }
-		catch (std::exception e)
+		cache_archive::blob blob;
+		if (archive && archive->find(path, blob))
 		{
-			BOOST_LOG_TRIVIAL(error) << e.what();
-			return false;
+			boost::iostreams::stream<boost::iostreams::array_source> stream{blob.data, blob.size};
+			if (import(stream, path, derived)) return true;
 		}
 
-		BOOST_LOG_TRIVIAL(info) << "Imported cache file " << path;
-		return true;
+		std::ifstream file{path.string(), std::ifstream::binary};
+		if (!file.is_open()) return false;
+		return import(file, path, derived);
 	}
 
 	template<typename derived>
@@ -91,6 +86,35 @@ public:
 
 
 	utility::checksum checksum;
+
+
+
+protected:
+	template<typename derived>
+	bool import( std::istream& stream, const path& path, derived& derived )
+	{
+		BOOST_LOG_TRIVIAL(info) << "Importing cache file " << path;
+
+		try 
+		{
+			if (utility::checksum{stream, from_binary_header} != checksum)
+			{
+				BOOST_LOG_TRIVIAL(info) << "Cache file is outdated " << path;
+				return false;
+			}
+
+			stream.seekg(0);
+			boost::archive::binary_iarchive{stream} >> derived; 
+		}
+		catch (std::exception e)
+		{
+			BOOST_LOG_TRIVIAL(error) << e.what();
+			return false;
+		}
+
+		BOOST_LOG_TRIVIAL(info) << "Imported cache file " << path;
+		return true;
+	}
 };
 
 
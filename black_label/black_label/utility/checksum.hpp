@@ -4,7 +4,7 @@
 #include <black_label/file_buffer.hpp>
 #include <black_label/path.hpp>
 
-#include <fstream>
+#include <istream>
 
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/crc.hpp>
@@ -37,20 +37,18 @@ public:
 
 
 	checksum() : value(0) {}
-	explicit checksum( path path ) : checksum{} 
+	explicit checksum( path path ) : checksum{file_buffer::file_buffer{path.string()}} {}
+	explicit checksum( const file_buffer::file_buffer& buffer ) : checksum{} 
 	{
-		file_buffer::file_buffer model_file{path.string()};
-		if (model_file.empty()) return;
-
-		value = black_label::utility::crc_32(model_file.data(), model_file.size());
-			return;
+		if (buffer.empty()) return;
+		value = black_label::utility::crc_32(buffer.data(), buffer.size());
 	}
-	checksum( std::ifstream& stream, from_binary_header_type ) 
+	checksum( std::istream& stream, from_binary_header_type ) 
 	{	
 		using namespace boost;
 		using namespace boost::archive;
 
-		assert(stream.is_open());
+		assert(stream.good());
 
 		class header
 		{
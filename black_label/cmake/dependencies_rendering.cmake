@@ -3,11 +3,12 @@ find_package(BlackLabel 0.1 QUIET REQUIRED file_buffer)
 list(APPEND BlackLabel_DEPENDENCIES_RENDERING_LIBRARIES ${BlackLabel_FILE_BUFFER_LIBRARIES})
 
 # Boost
-find_package(Boost ${COMMON_BOOST_VERSION} QUIET REQUIRED log serialization atomic)
+find_package(Boost ${COMMON_BOOST_VERSION} QUIET REQUIRED log serialization atomic iostreams)
 list(APPEND BlackLabel_DEPENDENCIES_RENDERING_INCLUDE_DIRS ${Boost_INCLUDE_DIRS})
 list(APPEND BlackLabel_DEPENDENCIES_RENDERING_LIBRARIES
 	${Boost_LOG_LIBRARIES}
-	${Boost_SERIALIZATION_LIBRARIES})
+	${Boost_SERIALIZATION_LIBRARIES}
+	${Boost_IOSTREAMS_LIBRARIES})
 
 # GLEW
 find_package(GLEW REQUIRED)
@@ -0,0 +1,94 @@
+// Upsamples the outputs of a pass that renders at a fraction of the
+// resolution. Generated by the pipeline (see pipeline::import):
+//
+//  GUIDE          Defined if guide, the full resolution depth texture, and
+//                 low_guide, the downsampled one that the pass used, are
+//                 given
+//  SOURCE_COUNT   The number of source_i to upsample into result_i (at
+//                 most 4)
+//
+// Joint bilateral upsampling. The four nearest low resolution texels are
+// weighted bilinearly and by how close their depths are to the full
+// resolution depth such that nothing bleeds across depth discontinuities.
+// Plain bilinear upsampling without a guide.
+
+#include "render_scale.glsl"
+
+uniform ivec2 window_dimensions;
+uniform mat4 projection_matrix;
+
+#ifdef GUIDE
+uniform sampler2D guide, low_guide;
+uniform vec2 guide_scale;
+#endif
+#if 0 < SOURCE_COUNT
+uniform sampler2D source_0;
+layout(location = 0) out vec4 result_0;
+#endif
+#if 1 < SOURCE_COUNT
+uniform sampler2D source_1;
+layout(location = 1) out vec4 result_1;
+#endif
+#if 2 < SOURCE_COUNT
+uniform sampler2D source_2;
+layout(location = 2) out vec4 result_2;
+#endif
+#if 3 < SOURCE_COUNT
+uniform sampler2D source_3;
+layout(location = 3) out vec4 result_3;
+#endif
+
+
+
+float get_ec_z( in float tc_z )
+{ return projection_matrix[3][2] / (-2.0 * tc_z + 1.0 - projection_matrix[2][2]); }
+
+void main()
+{
+	vec2 tc = gl_FragCoord.xy / vec2(window_dimensions);
+
+	// The four nearest low resolution texels
+	ivec2 low_size = textureSize(source_0, 0);
+	vec2 position = tc * vec2(low_size) - 0.5;
+	ivec2 base = ivec2(floor(position));
+	vec2 f = position - floor(position);
+	ivec2 texels[4] = ivec2[4](
+		clamp(base,               ivec2(0), low_size - 1),
+		clamp(base + ivec2(1, 0), ivec2(0), low_size - 1),
+		clamp(base + ivec2(0, 1), ivec2(0), low_size - 1),
+		clamp(base + ivec2(1, 1), ivec2(0), low_size - 1));
+	vec4 weights = vec4(
+		(1.0 - f.x) * (1.0 - f.y),
+		f.x * (1.0 - f.y),
+		(1.0 - f.x) * f.y,
+		f.x * f.y);
+
+#ifdef GUIDE
+	// Relative depth differences such that the falloff does not depend on the
+	// distance to the eye
+	const float epsilon = 1.0e-3;
+	float ec_z = get_ec_z(texture(guide, scale_tc(guide, tc, guide_scale)).x);
+	for (int i = 0; i < 4; ++i) {
+		float low_ec_z = get_ec_z(texelFetch(low_guide, texels[i], 0).x);
+		weights[i] /= epsilon + abs(ec_z - low_ec_z) / max(abs(ec_z), epsilon);
+	}
+#endif
+	weights /= max(dot(weights, vec4(1.0)), 1.0e-6);
+
+#if 0 < SOURCE_COUNT
+	result_0 = vec4(0.0);
+	for (int i = 0; i < 4; ++i) result_0 += weights[i] * texelFetch(source_0, texels[i], 0);
+#endif
+#if 1 < SOURCE_COUNT
+	result_1 = vec4(0.0);
+	for (int i = 0; i < 4; ++i) result_1 += weights[i] * texelFetch(source_1, texels[i], 0);
+#endif
+#if 2 < SOURCE_COUNT
+	result_2 = vec4(0.0);
+	for (int i = 0; i < 4; ++i) result_2 += weights[i] * texelFetch(source_2, texels[i], 0);
+#endif
+#if 3 < SOURCE_COUNT
+	result_3 = vec4(0.0);
+	for (int i = 0; i < 4; ++i) result_3 += weights[i] * texelFetch(source_3, texels[i], 0);
+#endif
+}
@@ -1,6 +1,8 @@
-uniform mat4 model_matrix;
-uniform mat4 model_view_projection_matrix;
-uniform mat3 normal_matrix;
+#extension GL_ARB_shader_draw_parameters : enable
+
+#include "instance_data.glsl"
+
+uniform mat4 view_projection_matrix;
 
 
 
@@ -20,8 +22,11 @@ out vertex_data vertex;
 
 void main()
 {
-	gl_Position = model_view_projection_matrix * oc_position;
-	vertex.wc_normal = normalize(normal_matrix * oc_normal);
-	vertex.wc_position = (model_matrix * oc_position).xyz;
+	instance_data instance = instances[get_instance_index()];
+	vec4 wc_position = instance.model_matrix * oc_position;
+
+	gl_Position = view_projection_matrix * wc_position;
+	vertex.wc_normal = normalize(mat3(instance.normal_matrix) * oc_normal);
+	vertex.wc_position = wc_position.xyz;
 	vertex.oc_texture_coordinate = oc_texture_coordinate;
 }
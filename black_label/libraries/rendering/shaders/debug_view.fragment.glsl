@@ -7,12 +7,7 @@ uniform ivec2 window_dimensions;
 
 
 
-struct view_type {
-	mat4 view_matrix, projection_matrix, view_projection_matrix;
-	vec4 eye;
-	vec4 right, forward, up;
-	ivec2 dimensions;
-};
+#include "view_type.glsl"
 
 
 layout(std140) uniform user_view_block
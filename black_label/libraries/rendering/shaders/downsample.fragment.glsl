@@ -0,0 +1,94 @@
+// Downsamples the inputs of a pass that renders at a fraction of the
+// resolution. Generated by the pipeline (see pipeline::import):
+//
+//  DEPTH          Defined if source_depth is downsampled into the depth
+//  COLOR_COUNT    The number of source_color_i (at most 4)
+//
+// Each texel is taken from one of the source texels in its footprint, which
+// spans 1 / resolution source texels along each axis. With a depth texture,
+// the nearest and the farthest of them are taken in a checkerboard pattern
+// such that both sides of depth discontinuities are kept. The other textures
+// are taken from the same place as the depth such that they stay consistent
+// with it. Only the part of each source that was rendered to is read (see
+// render_scale.glsl).
+
+uniform ivec2 window_dimensions;
+
+#ifdef DEPTH
+uniform sampler2D source_depth;
+uniform vec2 source_depth_scale;
+#endif
+#if 0 < COLOR_COUNT
+uniform sampler2D source_color_0;
+uniform vec2 source_color_0_scale;
+layout(location = 0) out vec4 color_0;
+#endif
+#if 1 < COLOR_COUNT
+uniform sampler2D source_color_1;
+uniform vec2 source_color_1_scale;
+layout(location = 1) out vec4 color_1;
+#endif
+#if 2 < COLOR_COUNT
+uniform sampler2D source_color_2;
+uniform vec2 source_color_2_scale;
+layout(location = 2) out vec4 color_2;
+#endif
+#if 3 < COLOR_COUNT
+uniform sampler2D source_color_3;
+uniform vec2 source_color_3_scale;
+layout(location = 3) out vec4 color_3;
+#endif
+
+
+
+// The texels of sampler that were rendered to, scale (see <name>_scale)
+ivec2 get_rendered_size( in sampler2D sampler, in vec2 scale )
+{ return max(ivec2(ceil(vec2(textureSize(sampler, 0)) * scale)), ivec2(1)); }
+
+// The texel at tc, where [0, 1] spans the rendered part of sampler
+ivec2 get_texel( in sampler2D sampler, in vec2 scale, in vec2 tc )
+{
+	ivec2 rendered_size = get_rendered_size(sampler, scale);
+	return clamp(ivec2(tc * vec2(rendered_size)), ivec2(0), rendered_size - 1);
+}
+
+void main()
+{
+	vec2 tc = gl_FragCoord.xy / vec2(window_dimensions);
+
+#ifdef DEPTH
+	// The source texels that the footprint of this texel overlaps
+	ivec2 rendered_size = get_rendered_size(source_depth, source_depth_scale);
+	vec2 ratio = vec2(rendered_size) / vec2(window_dimensions);
+	ivec2 first = clamp(ivec2(floor((gl_FragCoord.xy - 0.5) * ratio)), ivec2(0), rendered_size - 1);
+	ivec2 last = clamp(ivec2(ceil((gl_FragCoord.xy + 0.5) * ratio)) - 1, first, rendered_size - 1);
+
+	bool is_farthest = 0 != ((int(gl_FragCoord.x) + int(gl_FragCoord.y)) & 1);
+	ivec2 selected = first;
+	float depth = texelFetch(source_depth, first, 0).x;
+	for (int y = first.y; y <= last.y; ++y)
+		for (int x = first.x; x <= last.x; ++x) {
+			float sample_depth = texelFetch(source_depth, ivec2(x, y), 0).x;
+			if (is_farthest ? sample_depth > depth : sample_depth < depth) {
+				depth = sample_depth;
+				selected = ivec2(x, y);
+			}
+		}
+	gl_FragDepth = depth;
+
+	tc = (vec2(selected) + 0.5) / vec2(rendered_size);
+#endif
+
+#if 0 < COLOR_COUNT
+	color_0 = texelFetch(source_color_0, get_texel(source_color_0, source_color_0_scale, tc), 0);
+#endif
+#if 1 < COLOR_COUNT
+	color_1 = texelFetch(source_color_1, get_texel(source_color_1, source_color_1_scale, tc), 0);
+#endif
+#if 2 < COLOR_COUNT
+	color_2 = texelFetch(source_color_2, get_texel(source_color_2, source_color_2_scale, tc), 0);
+#endif
+#if 3 < COLOR_COUNT
+	color_3 = texelFetch(source_color_3, get_texel(source_color_3, source_color_3_scale, tc), 0);
+#endif
+}
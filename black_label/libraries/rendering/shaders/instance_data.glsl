@@ -0,0 +1,45 @@
+// The instances of the statics and the indices of the visible ones. Requires
+// GL_ARB_shader_draw_parameters to be enabled for indirect draws.
+
+// Matches instance_batches::instance (std430 layout)
+struct instance_data
+{
+	mat4 model_matrix;
+	mat4 normal_matrix;
+};
+layout(std430) readonly buffer instance_block
+{
+	instance_data instances[];
+};
+// The indices of the visible instances (see visibility)
+layout(std430) readonly buffer visible_block
+{
+	int visible_instances[];
+};
+// The offset into visible_instances of each indirect draw
+layout(std430) readonly buffer draw_block
+{
+	int draw_instance_offsets[];
+};
+uniform int instance_offset, draw_offset;
+uniform bool indirect;
+
+// With LAYERED, each instance is drawn once per view; see
+// basic_pass::layer_count
+#ifdef LAYERED
+uniform int layer_instance_count;
+#endif
+
+
+
+int get_instance_index()
+{
+#ifdef GL_ARB_shader_draw_parameters
+	if (indirect) return visible_instances[draw_instance_offsets[draw_offset + gl_DrawIDARB] + gl_InstanceID];
+#endif
+#ifdef LAYERED
+	return visible_instances[instance_offset + gl_InstanceID % layer_instance_count];
+#else
+	return visible_instances[instance_offset + gl_InstanceID];
+#endif
+}
@@ -5,8 +5,17 @@
 uniform sampler2D diffuse_texture;
 
 uniform ivec2 window_dimensions;
+// The offset of the heads of this layered depth map
 uniform uint32_t total_data_offset;
 
+// The offsets of the heads of each layered depth map; see ldm.vertex.glsl
+#ifdef LAYERED
+readonly restrict layout(std430) buffer data_offset_block
+{ uvec4 data_offsets[]; };
+
+flat in int view_id;
+#endif
+
 
 
 struct ldm_data {
@@ -30,7 +39,9 @@ in vertex_data vertex;
 
 
 
-uint32_t allocate() { return total_data_offset + atomicCounterIncrement(count); }
+// The nodes of all layered depth maps follow the heads of all of them. The
+// counter starts after the heads.
+uint32_t allocate() { return atomicCounterIncrement(count); }
 
 
 uint32_t compress( in vec4 color ) 
@@ -48,8 +59,14 @@ void main()
 	float depth = vertex.negative_ec_position_z;
 
 	// Calculate indices
+#ifdef LAYERED
+	uint32_t head = data_offsets[view_id].x + uint32_t(gl_FragCoord.x) + uint32_t(gl_FragCoord.y) * window_dimensions.x;
+#else
 	uint32_t head = total_data_offset + uint32_t(gl_FragCoord.x) + uint32_t(gl_FragCoord.y) * window_dimensions.x;
+#endif
 	uint32_t new = allocate();
+	// The counter keeps counting such that the buffer can be grown to fit
+	if (new >= data.length()) return;
 
 	// Store fragment data in node
 	//data[new].compressed_diffuse = compressed_diffuse;
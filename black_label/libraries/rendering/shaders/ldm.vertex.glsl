@@ -1,7 +1,22 @@
-uniform mat4 model_view_matrix;
-uniform mat4 model_view_projection_matrix;
+#extension GL_ARB_shader_draw_parameters : enable
+
+#include "instance_data.glsl"
+
+uniform mat4 view_matrix;
+uniform mat4 view_projection_matrix;
 uniform float z_far, z_near;
 
+// All layered depth maps are drawn at once. Each instance is drawn once per
+// view; see basic_pass::layer_count.
+#ifdef LAYERED
+#include "view_type.glsl"
+
+readonly restrict layout(std430) buffer view_block
+{ view_type views[]; };
+
+flat out int view_id;
+#endif
+
 
 
 layout(location = 0) in vec4 oc_position;
@@ -18,9 +33,15 @@ out vertex_data vertex;
 
 void main()
 {
-	gl_Position = model_view_projection_matrix * oc_position;
-
-	vec4 ec_position = model_view_matrix * oc_position;
+	vec4 wc_position = instances[get_instance_index()].model_matrix * oc_position;
+#ifdef LAYERED
+	view_id = gl_InstanceID / layer_instance_count;
+	gl_Position = views[view_id].view_projection_matrix * wc_position;
+	vec4 ec_position = views[view_id].view_matrix * wc_position;
+#else
+	gl_Position = view_projection_matrix * wc_position;
+	vec4 ec_position = view_matrix * wc_position;
+#endif
 	vertex.negative_ec_position_z = -ec_position.z;
 
 
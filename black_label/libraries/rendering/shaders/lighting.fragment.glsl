@@ -15,6 +15,10 @@ uniform sampler2D random;
 uniform sampler2D ambient_occlusion;
 uniform sampler2D shadow_map_0, shadow_map_1;
 uniform sampler2D photon_splats, light_albedos;
+// The outputs of scalable passes
+uniform vec2 ambient_occlusion_scale, photon_splats_scale;
+
+#include "render_scale.glsl"
 
 uniform samplerBuffer lights;
 #ifdef USE_TILED_SHADING
@@ -375,12 +379,7 @@ vec4 get_photon_splats() {
 
 
 
-struct view_type {
-	mat4 view_matrix, projection_matrix, view_projection_matrix;
-	vec4 eye;
-	vec4 right, forward, up;
-	ivec2 dimensions;
-};
+#include "view_type.glsl"
 
 layout(std140) uniform user_view_block
 { view_type user_view; };
@@ -568,7 +567,7 @@ float trace_ambient_occlusion( in vec3 wc_position, in vec3 wc_normal ) {
 
 
 vec4 get_photon_splats_from_texture( vec2 tc_window ) {
-	return texture(photon_splats, tc_window);
+	return texture(photon_splats, scale_tc(photon_splats, tc_window, photon_splats_scale));
 }
 
 
@@ -581,7 +580,7 @@ void main()
 	vec3 wc_view_direction = normalize(vertex.wc_view_ray_direction);
 	vec3 albedo = texture(albedos, tc_window).xyz;
 
-	float ambient_occlusion_factor = texture(ambient_occlusion, tc_window).a;
+	float ambient_occlusion_factor = texture(ambient_occlusion, scale_tc(ambient_occlusion, tc_window, ambient_occlusion_scale)).a;
 
 /*
 	float roughness = 1.0;
@@ -1,5 +1,8 @@
-uniform mat4 model_view_matrix;
-uniform mat4 model_view_projection_matrix;
+#extension GL_ARB_shader_draw_parameters : enable
+
+#include "instance_data.glsl"
+
+uniform mat4 view_projection_matrix;
 uniform float z_near, z_far;
 
 
@@ -10,5 +13,5 @@ in vec4 oc_position;
 
 void main()
 {
-	gl_Position = model_view_projection_matrix * oc_position;
+	gl_Position = view_projection_matrix * instances[get_instance_index()].model_matrix * oc_position;
 }
@@ -1,14 +1,15 @@
 uniform mat4 view_matrix;
 uniform mat4 view_projection_matrix;
-uniform uint photon_count;
 
 
 
-layout(location = 0) in vec3 wc_position;
-layout(location = 1) in vec3 wc_normal;
-layout(location = 2) in vec3 Du_x;
-layout(location = 3) in vec3 Dv_x;
-layout(location = 4) in vec4 radiant_flux;
+struct photon_data {
+	vec4 wc_position, wc_normal, Du_x, Dv_x, radiant_flux;
+};
+readonly restrict layout(std430) buffer photon_buffer
+{ photon_data photons[]; };
+
+
 
 out photon_data {
 	vec3 wc_position, Du_x, Dv_x;
@@ -24,6 +25,22 @@ mat3 mat3_from_rows( in vec3 row1, in vec3 row2, in vec3 row3 ) {
 }
 
 void main() {
+	// The draw count is the number of traced photons which may exceed the
+	// number of photons that fit in the buffer. These are given no area.
+	if (gl_VertexID >= photons.length()) {
+		gl_Position = vec4(0.0);
+		photon.wc_position = photon.Du_x = photon.Dv_x = vec3(0.0);
+		photon.irradiance = vec4(0.0);
+		photon.M = mat3(0.0);
+		return;
+	}
+
+	vec3 wc_position = photons[gl_VertexID].wc_position.xyz;
+	vec3 wc_normal = photons[gl_VertexID].wc_normal.xyz;
+	vec3 Du_x = photons[gl_VertexID].Du_x.xyz;
+	vec3 Dv_x = photons[gl_VertexID].Dv_x.xyz;
+	vec4 radiant_flux = photons[gl_VertexID].radiant_flux;
+
 	gl_Position = view_projection_matrix * vec4(wc_position, 1.0);
 	photon.wc_position = wc_position;
 
@@ -9,12 +9,7 @@ uniform vec3 wc_view_eye_position;
 
 
 
-struct view_type {
-	mat4 view_matrix, projection_matrix, view_projection_matrix;
-	vec4 eye;
-	vec4 right, forward, up;
-	ivec2 dimensions;
-};
+#include "view_type.glsl"
 
 layout(std140) uniform current_view_block
 { view_type current_view; };
@@ -149,7 +144,10 @@ void store_photon( in vec3 wc_position, in vec3 wc_normal, in photon_differentia
 	const float photon_footprint_bias = 0.5;
 	if (photon_footprint_bias < max_x) return;
 
+	// The counter keeps counting past the end of the buffer such that the
+	// buffer can be grown to fit
 	uint32_t id = atomicCounterIncrement(photon_count);
+	if (id >= photons.length()) return;
 
 	photons[id].wc_position = vec4(wc_position, 1.0);
 	photons[id].wc_normal = vec4(wc_normal, 0.0);
@@ -9,12 +9,7 @@ uniform vec3 wc_view_eye_position;
 
 
 
-struct view_type {
-	mat4 view_matrix, projection_matrix, view_projection_matrix;
-	vec4 eye;
-	vec4 right, forward, up;
-	ivec2 dimensions;
-};
+#include "view_type.glsl"
 
 layout(std140) uniform current_view_block
 { view_type current_view; };
@@ -0,0 +1,9 @@
+// The texture coordinates of tc in a texture of which a scalable pass only
+// rendered to the lower left part, scale (see <name>_scale). Clamped half a
+// texel inside that part such that linear filtering upsamples without
+// reading what was not rendered.
+vec2 scale_tc( in sampler2D sampler, in vec2 tc, in vec2 scale )
+{
+	vec2 half_texel = 0.5 / vec2(textureSize(sampler, 0));
+	return min(tc * scale, scale - half_texel);
+}
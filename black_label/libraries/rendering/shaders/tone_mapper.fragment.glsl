@@ -1,6 +1,10 @@
 uniform sampler2D lit;
 uniform sampler2D bloom;
 uniform sampler3D lut;
+// Rendered by a scalable pass
+uniform vec2 lit_scale;
+
+#include "render_scale.glsl"
 
 
 
@@ -65,7 +69,7 @@ vec3 srgb_to_linear( in vec3 color )
 void main()
 {
 	vec2 tc = gl_FragCoord.xy / vec2(textureSize(lit, 0));
-	result = texture(lit, tc);
+	result = texture(lit, scale_tc(lit, tc, lit_scale));
 
 	//result.rgb = f(result.rgb) / f(vec3(LinearWhite));
 
@@ -0,0 +1,7 @@
+// Matches pass::view_data (std140 and std430 layout)
+struct view_type {
+	mat4 view_matrix, projection_matrix, view_projection_matrix;
+	vec4 eye;
+	vec4 right, forward, up;
+	ivec2 dimensions;
+};
@@ -31,10 +31,14 @@
 #include <boost/optional.hpp>
 #endif
 
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/Importer.hpp>
+#include <assimp/IOStream.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <cstring>
+
 #endif // #ifdef DEVELOPER_TOOLS
 
 
@@ -52,16 +56,28 @@ namespace cpu {
 
 
 
-bool model::import( path path )
+bool model::import( path path, const cache_archive* archive )
+{
+	if (cache_file::import(path, *this, archive))
+		return true;
+	return import_source(path, file_buffer::file_buffer{path.string()});
+}
+
+bool model::import( const path& path, const file_buffer::file_buffer& source, const cache_archive* archive )
 {
-	if (cache_file::import(path, *this))
+	if (cache_file::import(path, *this, archive))
 		return true;
+	return import_source(path, source);
+}
+
+bool model::import_source( const path& path, const file_buffer::file_buffer& source )
+{
 #ifdef DEVELOPER_TOOLS
 	if (
 #ifndef NO_FBX
 //		(".fbx" == path.extension() && import_fbxsdk(path)) || 
 #endif
-		import_assimp(path))
+		import_assimp(path, source))
 		if (cache_file::export(path, *this))
 			return true;
 #endif // #ifdef DEVELOPER_TOOLS
@@ -713,11 +729,82 @@ aiMatrix4x4 get_global_transformation( const aiNode* node )
 
 
 
-bool model::import_assimp( path path )
+////////////////////////////////////////////////////////////////////////////////
+/// Memory IO System
+///
+/// Serves the model file from memory and any other file (e.g., a material 
+/// library) from disk. This lets Assimp parse the bytes that were checksummed.
+////////////////////////////////////////////////////////////////////////////////
+class memory_io_stream : public Assimp::IOStream
+{
+public:
+	memory_io_stream( const char* data, size_t size ) : data{data}, size{size}, position{0} {}
+
+	size_t Read( void* buffer, size_t element_size, size_t count )
+	{
+		if (0 == element_size) return 0;
+		count = std::min(count, (size - position) / element_size);
+		memcpy(buffer, data + position, element_size * count);
+		position += element_size * count;
+		return count;
+	}
+	size_t Write( const void* buffer, size_t element_size, size_t count ) { return 0; }
+	aiReturn Seek( size_t offset, aiOrigin origin )
+	{
+		size_t new_position;
+		switch (origin)
+		{
+		case aiOrigin_SET: new_position = offset; break;
+		case aiOrigin_CUR: new_position = position + offset; break;
+		case aiOrigin_END: new_position = size - offset; break;
+		default: return aiReturn_FAILURE;
+		}
+		if (size < new_position) return aiReturn_FAILURE;
+		position = new_position;
+		return aiReturn_SUCCESS;
+	}
+	size_t Tell() const { return position; }
+	size_t FileSize() const { return size; }
+	void Flush() {}
+
+protected:
+	const char* data;
+	size_t size, position;
+};
+
+class memory_io_system : public Assimp::DefaultIOSystem
+{
+public:
+	memory_io_system( const black_label::path& file, const file_buffer::file_buffer& source ) 
+		: file(file)
+		, source(source)
+	{}
+
+	bool Exists( const char* path ) const
+	{ return is_source(path) || DefaultIOSystem::Exists(path); }
+	Assimp::IOStream* Open( const char* path, const char* mode = "rb" )
+	{
+		if ('w' != mode[0] && is_source(path)) return new memory_io_stream{source.data(), source.size()};
+		return DefaultIOSystem::Open(path, mode);
+	}
+
+protected:
+	bool is_source( const char* path ) const
+	{ return black_label::path{path}.make_preferred() == file; }
+
+	black_label::path file;
+	const file_buffer::file_buffer& source;
+};
+
+
+
+bool model::import_assimp( const path& path, const file_buffer::file_buffer& source )
 {
 	BOOST_LOG_TRIVIAL(info) << "Assimp is importing " << path;
 
 	Assimp::Importer importer;
+	// The importer takes ownership
+	importer.SetIOHandler(new memory_io_system{black_label::path{path}.make_preferred(), source});
 	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, aiComponent_COLORS);
 	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT, 1024 * 1024);
 	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, 1024 * 1024 / 3);
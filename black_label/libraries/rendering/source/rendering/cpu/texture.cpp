@@ -26,12 +26,24 @@ namespace black_label {
 namespace rendering {
 namespace cpu {
 
-bool texture::import( path path )
+bool texture::import( path path, const cache_archive* archive )
 {
-	if (cache_file::import(path, *this))
+	if (cache_file::import(path, *this, archive))
 		return true;
+	return import_source(path, file_buffer::file_buffer{path.string()});
+}
+
+bool texture::import( const path& path, const file_buffer::file_buffer& source, const cache_archive* archive )
+{
+	if (cache_file::import(path, *this, archive))
+		return true;
+	return import_source(path, source);
+}
+
+bool texture::import_source( const path& path, const file_buffer::file_buffer& source )
+{
 #ifdef DEVELOPER_TOOLS
-	if (import_sfml(path))
+	if (import_sfml(path, source))
 	{
 		compress();
 		if (cache_file::export(path, *this))
@@ -47,14 +59,16 @@ bool texture::import( path path )
 
 #ifdef DEVELOPER_TOOLS
 
-bool texture::import_sfml( path path )
+bool texture::import_sfml( const path& path, const file_buffer::file_buffer& source )
 {
 	BOOST_LOG_TRIVIAL(info) << "Importing texture using SFML " << path;
 
+	if (source.empty()) return false;
+
 	Image image;
 	{
 		scoped_stream_suppression suppress(stdout);
-		if (!image.loadFromFile(path.string()))
+		if (!image.loadFromMemory(source.data(), source.size()))
 		 return false;
 	}
 
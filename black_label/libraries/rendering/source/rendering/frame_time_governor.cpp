@@ -0,0 +1,50 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/frame_time_governor.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace black_label {
+namespace rendering {
+
+using namespace std;
+using namespace std::chrono;
+
+const double 
+	frame_time_governor::tolerance{0.05}, 
+	frame_time_governor::max_step{0.05};
+
+void frame_time_governor::update( 
+	nanoseconds frame_time, 
+	const vector<pass>& passes, 
+	const render_graph& graph ) const
+{
+	// Nothing is read back during the first frames
+	if (!is_enabled() || nanoseconds::zero() >= frame_time) return;
+
+	nanoseconds scalable_time{0};
+	for (render_graph::index_type index{0}; passes.size() > index; ++index)
+		if (!graph.is_culled(index) && passes[index].is_scalable())
+			scalable_time += passes[index].timer.gpu_time;
+	if (nanoseconds::zero() >= scalable_time) return;
+
+	auto error = static_cast<double>(frame_time.count()) / target_frame_time.count() - 1.0;
+	if (tolerance > abs(error)) return;
+
+	// The time left for the scalable passes once the fixed ones are done
+	auto budget = max(target_frame_time - (frame_time - scalable_time), nanoseconds::zero());
+	auto step = sqrt(static_cast<double>(budget.count()) / scalable_time.count());
+	step = min(max(step, 1.0 - max_step), 1.0 + max_step);
+
+	for (render_graph::index_type index{0}; passes.size() > index; ++index) {
+		const auto& pass = passes[index];
+		if (graph.is_culled(index) || !pass.is_scalable()) continue;
+		pass.render_scale = min(max(static_cast<float>(pass.render_scale * step), 
+			pass.min_render_scale), pass.max_render_scale);
+	}
+}
+
+} // namespace rendering
+} // namespace black_label
@@ -21,12 +21,14 @@ namespace target {
 		element_array = GL_ELEMENT_ARRAY_BUFFER,
 		uniform_buffer = GL_UNIFORM_BUFFER,
 		shader_storage = GL_SHADER_STORAGE_BUFFER,
-		atomic_counter = GL_ATOMIC_COUNTER_BUFFER;
+		atomic_counter = GL_ATOMIC_COUNTER_BUFFER,
+		draw_indirect = GL_DRAW_INDIRECT_BUFFER;
 } // namespace target
 
 namespace usage {
 	const type
 		stream_draw = GL_STREAM_DRAW,
+		stream_read = GL_STREAM_READ,
 		static_draw = GL_STATIC_DRAW,
 		dynamic_draw = GL_DYNAMIC_DRAW,
 		dynamic_copy = GL_DYNAMIC_COPY;
@@ -57,17 +59,28 @@ void basic_buffer::unbind()
 	unbind(target::uniform_buffer);
 	unbind(target::shader_storage);
 	unbind(target::atomic_counter);
+	unbind(target::draw_indirect);
 }
 
 void basic_buffer::bind( target::type target, index_type index ) const
 { glBindBufferBase(target, index, id); }
 
+void basic_buffer::bind( target::type target, index_type index, offset_type offset, size_type size ) const
+{ glBindBufferRange(target, index, id, offset, size); }
+
 void basic_buffer::update( target::type target, usage::type usage, size_type size, const void* data ) const
 { glBufferData(target, size, data, usage); }
 
 void basic_buffer::update( target::type target, offset_type offset, size_type size, const void* data ) const
 { glBufferSubData(target, offset, size, data); }
 
+basic_buffer::offset_type basic_buffer::uniform_buffer_offset_alignment()
+{
+	static GLint alignment{0};
+	if (0 == alignment) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return alignment;
+}
+
 
     
 } // namespace gpu
@@ -0,0 +1,63 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/gpu/buffer_pool.hpp>
+
+#include <algorithm>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+bool buffer_pool::reserve( const std::string& name, const buffer& buffer, size_type size )
+{
+	auto new_size = request(name, buffer.allocated_size, size);
+	if (buffer.allocated_size == new_size) return false;
+	buffer.bind_and_update(new_size);
+	return true;
+}
+
+buffer_pool::size_type buffer_pool::request( const std::string& name, size_type allocated_size, size_type size )
+{
+	auto& entry = entries[name];
+	entry.size = size;
+	entry.high_water_mark = std::max(entry.high_water_mark, size);
+	entry.allocated_size = allocated_size;
+
+	auto reallocate = [&entry] ( size_type new_size ) {
+		entry.shrink_high_water_mark = 0;
+		entry.requests_below_shrink_threshold = 0;
+		++entry.reallocations;
+		entry.allocated_size = new_size;
+		return new_size;
+	};
+
+	// Grow
+	if (allocated_size < size)
+		return reallocate(round_up(size));
+
+	// Shrink
+	if (allocated_size / 4 < size) {
+		entry.shrink_high_water_mark = 0;
+		entry.requests_below_shrink_threshold = 0;
+		return allocated_size;
+	}
+	entry.shrink_high_water_mark = std::max(entry.shrink_high_water_mark, size);
+	if (shrink_delay > entry.requests_below_shrink_threshold)
+		++entry.requests_below_shrink_threshold;
+	auto new_size = round_up(entry.shrink_high_water_mark);
+	if (shrink_delay <= entry.requests_below_shrink_threshold && new_size < allocated_size)
+		return reallocate(new_size);
+	return allocated_size;
+}
+
+buffer_pool::size_type buffer_pool::round_up( size_type size )
+{
+	size_type result{min_size};
+	while (result < size) result *= 2;
+	return result;
+}
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
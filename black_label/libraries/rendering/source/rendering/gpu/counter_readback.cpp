@@ -0,0 +1,63 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/gpu/counter_readback.hpp>
+
+#include <GL/glew.h>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+counter_readback::~counter_readback()
+{
+	for (auto& slot : slots)
+		if (slot.fence) glDeleteSync(static_cast<GLsync>(slot.fence));
+}
+
+void counter_readback::copy( const buffer& counter )
+{
+	auto& slot = slots[next];
+	next = (next + 1) % latency;
+
+	if (!slot.staging.valid())
+		slot.staging = buffer{target::array, usage::stream_read, sizeof(std::uint32_t)};
+
+	// Makes shader writes (e.g., by atomic counters) visible to the copy
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	glBindBuffer(GL_COPY_READ_BUFFER, counter);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, slot.staging);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(std::uint32_t));
+
+	// A copy that was never read is simply replaced
+	if (slot.fence) glDeleteSync(static_cast<GLsync>(slot.fence));
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool counter_readback::read( std::uint32_t& value )
+{
+	bool result{false};
+
+	// From the oldest to the most recent copy
+	for (int i{0}; latency > i; ++i) {
+		auto& slot = slots[(next + i) % latency];
+		if (!slot.fence) continue;
+
+		GLint status;
+		glGetSynciv(static_cast<GLsync>(slot.fence), GL_SYNC_STATUS, sizeof(status), nullptr, &status);
+		if (GL_SIGNALED != status) break;
+
+		glDeleteSync(static_cast<GLsync>(slot.fence));
+		slot.fence = nullptr;
+
+		glBindBuffer(GL_COPY_READ_BUFFER, slot.staging);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(std::uint32_t), &value);
+		result = true;
+	}
+
+	return result;
+}
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
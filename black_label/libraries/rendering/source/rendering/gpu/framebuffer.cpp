@@ -1,5 +1,6 @@
 #define BLACK_LABEL_SHARED_LIBRARY_EXPORT
 #include <black_label/rendering/gpu/framebuffer.hpp>
+#include <black_label/rendering/gpu/state_cache.hpp>
 
 #include <GL/glew.h>
 
@@ -15,16 +16,20 @@ namespace gpu {
 /// Basic Frameuffer
 ////////////////////////////////////////////////////////////////////////////////
 basic_framebuffer::~basic_framebuffer()
-{ if (valid()) glDeleteFramebuffers(1, &id); }
+{
+	if (!valid()) return;
+	state_cache::get().forget_framebuffer(id);
+	glDeleteFramebuffers(1, &id);
+}
 
 void basic_framebuffer::generate()
 { glGenFramebuffers(1, &id); }
 
 void basic_framebuffer::bind() const
-{ glBindFramebuffer(GL_FRAMEBUFFER, id); }
+{ state_cache::get().bind_framebuffer(id); }
 
 void basic_framebuffer::unbind()
-{ glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+{ state_cache::get().bind_framebuffer(0); }
 
 void basic_framebuffer::attach_texture_2d( attachment_type attachment, basic_texture::id_type texture ) const 
 { glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0); }
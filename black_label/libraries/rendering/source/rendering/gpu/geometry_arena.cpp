@@ -0,0 +1,155 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/gpu/geometry_arena.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+#include <GL/glew.h>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+namespace {
+
+// Floats per vertex of each attribute
+const int attribute_sizes[] = {3, 3, 2};
+
+bool has_attribute( int format, int attribute )
+{ return 0 == attribute || 0 != (format & attribute); }
+
+void copy( const buffer& source, const buffer& destination, GLintptr source_offset, GLintptr destination_offset, GLsizeiptr size )
+{
+	if (0 == size) return;
+	glBindBuffer(GL_COPY_READ_BUFFER, source);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source_offset, destination_offset, size);
+}
+
+} // namespace
+
+
+
+geometry_arena::geometry_arena( int format )
+	: format{format}
+	, vertex_count{0}
+	, vertex_capacity{0}
+	, index_count{0}
+	, index_capacity{0}
+{}
+
+buffer::size_type geometry_arena::vertex_size() const
+{
+	buffer::size_type result{0};
+	for (int attribute{0}; 3 > attribute; ++attribute)
+		if (has_attribute(format, attribute)) result += attribute_sizes[attribute] * sizeof(float);
+	return result;
+}
+
+geometry_range_pointer geometry_arena::insert(
+	const float* vertices_begin,
+	const float* vertices_end,
+	const float* normals_begin,
+	const float* texture_coordinates_begin,
+	const unsigned int* indices_begin,
+	const unsigned int* indices_end )
+{
+	auto vertices = static_cast<int>(vertices_end - vertices_begin) / 3;
+	auto indices = (indices_begin != indices_end)
+		? static_cast<unsigned int>(indices_end - indices_begin)
+		: static_cast<unsigned int>(vertices);
+
+	reserve(vertices, indices);
+
+	auto range = std::make_shared<geometry_range>(geometry_range{this, vertex_count, vertices, index_count, indices});
+	ranges.emplace_back(range);
+
+	const float* attributes[] = {vertices_begin, normals_begin, texture_coordinates_begin};
+	for (int attribute{0}; 3 > attribute; ++attribute) {
+		if (!has_attribute(format, attribute)) continue;
+		auto size = static_cast<GLsizeiptr>(attribute_sizes[attribute] * sizeof(float));
+		vertex_buffers[attribute].bind_and_update(vertex_count * size, vertices * size, attributes[attribute]);
+	}
+
+	if (indices_begin != indices_end)
+		index_buffer.bind_and_update(index_count * sizeof(unsigned int), indices * sizeof(unsigned int), indices_begin);
+	else {
+		std::vector<unsigned int> trivial_indices(indices);
+		std::iota(trivial_indices.begin(), trivial_indices.end(), 0u);
+		index_buffer.bind_and_update(index_count * sizeof(unsigned int), indices * sizeof(unsigned int), trivial_indices.data());
+	}
+
+	vertex_count += vertices;
+	index_count += indices;
+	return range;
+}
+
+void geometry_arena::reserve( int vertices, unsigned int indices )
+{
+	using namespace std;
+
+	if (vertex_capacity >= vertex_count + vertices && index_capacity >= index_count + indices) return;
+
+	// Only the live ranges are kept
+	vector<geometry_range_pointer> live_ranges;
+	int live_vertices{0};
+	unsigned int live_indices{0};
+	for (const auto& range : ranges) {
+		auto locked_range = range.lock();
+		if (!locked_range) continue;
+		live_vertices += locked_range->vertex_count;
+		live_indices += locked_range->index_count;
+		live_ranges.emplace_back(move(locked_range));
+	}
+	ranges.assign(live_ranges.cbegin(), live_ranges.cend());
+
+	vertex_capacity = max({2 * vertex_capacity, live_vertices + vertices, 1024});
+	index_capacity = max({2 * index_capacity, live_indices + indices, 1024u});
+
+	// The index buffer is only bound as an element array by the vertex array;
+	// binding it elsewhere would alter the bound vertex array.
+	buffer new_vertex_buffers[3], new_index_buffer{target::array, usage::static_draw, static_cast<buffer::size_type>(index_capacity * sizeof(unsigned int))};
+	for (int attribute{0}; 3 > attribute; ++attribute)
+		if (has_attribute(format, attribute))
+			new_vertex_buffers[attribute] = buffer{target::array, usage::static_draw, static_cast<buffer::size_type>(vertex_capacity * attribute_sizes[attribute] * sizeof(float))};
+
+	// Compact the live ranges into the new buffers. The indices are relative
+	// to the base vertex so they are copied as is.
+	vertex_count = 0;
+	index_count = 0;
+	for (const auto& range : live_ranges) {
+		for (int attribute{0}; 3 > attribute; ++attribute) {
+			if (!has_attribute(format, attribute)) continue;
+			auto size = static_cast<GLsizeiptr>(attribute_sizes[attribute] * sizeof(float));
+			copy(vertex_buffers[attribute], new_vertex_buffers[attribute], range->base_vertex * size, vertex_count * size, range->vertex_count * size);
+		}
+		copy(index_buffer, new_index_buffer, range->first_index * sizeof(unsigned int), index_count * sizeof(unsigned int), range->index_count * sizeof(unsigned int));
+
+		range->base_vertex = vertex_count;
+		range->first_index = index_count;
+		vertex_count += range->vertex_count;
+		index_count += range->index_count;
+	}
+
+	for (int attribute{0}; 3 > attribute; ++attribute)
+		swap(vertex_buffers[attribute], new_vertex_buffers[attribute]);
+	swap(index_buffer, new_index_buffer);
+
+	// The vertex array refers to the buffers so it is rebuilt
+	vertex_array = gpu::vertex_array{generate};
+	vertex_array.bind();
+	for (int attribute{0}; 3 > attribute; ++attribute) {
+		if (!has_attribute(format, attribute)) continue;
+		vertex_buffers[attribute].bind();
+		auto index = static_cast<gpu::vertex_array::index_type>(attribute);
+		vertex_array.add_attribute(index, attribute_sizes[attribute], nullptr);
+	}
+	index_buffer.basic_buffer::bind(target::element_array);
+	vertex_array.unbind();
+}
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
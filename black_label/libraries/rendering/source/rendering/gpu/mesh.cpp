@@ -12,36 +12,48 @@ draw_mode::draw_mode() : internal{GL_TRIANGLES} {}
 
 namespace gpu {
 
-void mesh::render( const core_program& program, unsigned int texture_unit ) const
+void mesh::render( const core_program& program, const material_uniforms& uniforms, unsigned int texture_unit, int instance_count ) const
+{
+	use_material(program, uniforms, texture_unit);
+	render(instance_count);
+}
+
+void mesh::use_material( const core_program& program, const material_uniforms& uniforms, unsigned int texture_unit ) const
 {
 	if (diffuse && diffuse->valid())
-		diffuse->use(program, "diffuse_texture", texture_unit);
-	else {
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		program.set_uniform("diffuse_texture", 0);
-	}
+		diffuse->use(program, uniforms.diffuse_texture, texture_unit);
+	else
+		basic_texture::use_none(target::texture_2d, program, uniforms.diffuse_texture, texture_unit);
 
 	if (specular && specular->valid())
 	{
-		specular->use(program, "specular_texture", texture_unit);
-		program.set_uniform("specular_exponent", 1.0f);
+		specular->use(program, uniforms.specular_texture, texture_unit);
+		program.set_uniform(uniforms.specular_exponent, 1.0f);
 	}
 	else {
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, 0);
-		program.set_uniform("specular_texture", 0);
-		program.set_uniform("specular_exponent", 0.0f);
+		basic_texture::use_none(target::texture_2d, program, uniforms.specular_texture, texture_unit);
+		program.set_uniform(uniforms.specular_exponent, 0.0f);
 	}
-
-	render();
 }
 
-void mesh::render() const
+void mesh::render( int instance_count ) const
 {
+	if (geometry) {
+		geometry->arena->bind();
+		auto first_index = reinterpret_cast<const void*>(geometry->first_index * sizeof(unsigned int));
+		glDrawElementsInstancedBaseVertex(draw_mode, draw_count, GL_UNSIGNED_INT, first_index, instance_count, geometry->base_vertex);
+		return;
+	}
+
 	vertex_array.bind();
 
-	if (has_indices())
+	if (1 != instance_count) {
+		if (has_indices())
+			glDrawElementsInstanced(draw_mode, draw_count, GL_UNSIGNED_INT, nullptr, instance_count);
+		else
+			glDrawArraysInstanced(draw_mode, 0, draw_count, instance_count);
+	}
+	else if (has_indices())
 		glDrawElements(draw_mode, draw_count, GL_UNSIGNED_INT, nullptr);
 	else
 		glDrawArrays(draw_mode, 0, draw_count);
@@ -0,0 +1,139 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/gpu/state_cache.hpp>
+
+#include <GL/glew.h>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+namespace {
+
+std::uint64_t make_key( unsigned int high, unsigned int low )
+{ return (std::uint64_t{high} << 32) | low; }
+
+} // namespace
+
+
+
+state_cache& state_cache::get()
+{
+	// Never destroyed since static OpenGL objects forget themselves on exit
+	static auto instance = new state_cache;
+	return *instance;
+}
+
+void state_cache::invalidate()
+{
+	program = framebuffer = vertex_array = unknown;
+	texture_unit = cull_face_mode = unknown;
+	viewport_x = viewport_y = viewport_width = viewport_height = -1;
+	textures.clear();
+	capabilities.clear();
+}
+
+void state_cache::use_program( id_type program )
+{
+	if (!issue(this->program != program)) return;
+	glUseProgram(program);
+	this->program = program;
+}
+
+void state_cache::bind_framebuffer( id_type framebuffer )
+{
+	if (!issue(this->framebuffer != framebuffer)) return;
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	this->framebuffer = framebuffer;
+}
+
+void state_cache::bind_vertex_array( id_type vertex_array )
+{
+	if (!issue(this->vertex_array != vertex_array)) return;
+	glBindVertexArray(vertex_array);
+	this->vertex_array = vertex_array;
+}
+
+void state_cache::active_texture( unsigned int texture_unit )
+{
+	if (!issue(this->texture_unit != texture_unit)) return;
+	glActiveTexture(GL_TEXTURE0 + texture_unit);
+	this->texture_unit = texture_unit;
+}
+
+void state_cache::bind_texture( unsigned int target, id_type texture )
+{
+	// Without a known active texture unit the binding cannot be tracked
+	if (unknown == texture_unit) {
+		issue(true);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	auto& bound = textures.emplace(make_key(texture_unit, target), id_type{unknown}).first->second;
+	if (!issue(bound != texture)) return;
+	glBindTexture(target, texture);
+	bound = texture;
+}
+
+void state_cache::viewport( int x, int y, int width, int height )
+{
+	if (!issue(viewport_x != x || viewport_y != y || viewport_width != width || viewport_height != height)) return;
+	glViewport(x, y, width, height);
+	viewport_x = x;
+	viewport_y = y;
+	viewport_width = width;
+	viewport_height = height;
+}
+
+void state_cache::set_capability( unsigned int capability, bool enabled )
+{
+	auto known = capabilities.find(capability);
+	if (!issue(capabilities.end() == known || known->second != enabled)) return;
+	if (enabled) glEnable(capability);
+	else glDisable(capability);
+	capabilities[capability] = enabled;
+}
+
+void state_cache::cull_face( unsigned int mode )
+{
+	if (!issue(cull_face_mode != mode)) return;
+	glCullFace(mode);
+	cull_face_mode = mode;
+}
+
+void state_cache::set_uniform( id_type program, unsigned int location, int value )
+{
+	// Inactive uniforms
+	if (~0u == location) return;
+
+	auto known = uniforms.find(make_key(program, location));
+	if (!issue(uniforms.end() == known || known->second != value)) return;
+	glUniform1i(location, value);
+	uniforms[make_key(program, location)] = value;
+}
+
+void state_cache::forget_program( id_type program )
+{
+	if (this->program == program) this->program = unknown;
+	for (auto uniform = uniforms.begin(); uniforms.end() != uniform;)
+		if (program == uniform->first >> 32) uniform = uniforms.erase(uniform);
+		else ++uniform;
+}
+
+void state_cache::forget_framebuffer( id_type framebuffer )
+{ if (this->framebuffer == framebuffer) this->framebuffer = unknown; }
+
+void state_cache::forget_vertex_array( id_type vertex_array )
+{ if (this->vertex_array == vertex_array) this->vertex_array = unknown; }
+
+void state_cache::forget_texture( id_type texture )
+{
+	for (auto& bound : textures)
+		if (texture == bound.second) bound.second = unknown;
+}
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
@@ -1,6 +1,8 @@
 #define BLACK_LABEL_SHARED_LIBRARY_EXPORT
 #include <black_label/rendering/gpu/texture.hpp>
+#include <black_label/rendering/gpu/state_cache.hpp>
 
+#include <algorithm>
 #include <cassert>
 
 #include <GL/glew.h>
@@ -67,12 +69,16 @@ namespace data_type {
 ////////////////////////////////////////////////////////////////////////////////
 
 basic_texture::~basic_texture()
-{ if (valid()) glDeleteTextures(1, &id); }
+{
+	if (!valid()) return;
+	glDeleteTextures(1, &id);
+	state_cache::get().forget_texture(id);
+}
 
 
 
 void basic_texture::bind( target::type target ) const
-{ glBindTexture(target, id); }
+{ state_cache::get().bind_texture(target, id); }
 
 void basic_texture::set_parameters( target::type target, filter::type filter, wrap::type wrap ) const
 {
@@ -92,10 +98,20 @@ void basic_texture::set_parameters( target::type target, filter::type filter, wr
 }
 
 void basic_texture::use( target::type target, const core_program& program, const char* name, unsigned int& texture_unit ) const
+{ use(target, program, program.get_uniform_location(name), texture_unit); }
+
+void basic_texture::use( target::type target, const core_program& program, unsigned int location, unsigned int& texture_unit ) const
+{ use_texture(target, program, location, texture_unit, id); }
+
+void basic_texture::use_none( target::type target, const core_program& program, unsigned int location, unsigned int& texture_unit )
+{ use_texture(target, program, location, texture_unit, invalid_id); }
+
+void basic_texture::use_texture( target::type target, const core_program& program, unsigned int location, unsigned int& texture_unit, id_type id )
 {
-	glActiveTexture(GL_TEXTURE0 + texture_unit);
-	program.set_uniform(name, static_cast<int>(texture_unit++));
-	bind(target);
+	auto& state = state_cache::get();
+	state.active_texture(texture_unit);
+	state.set_uniform(program.id, location, static_cast<int>(texture_unit++));
+	state.bind_texture(target, id);
 }
 
 
@@ -170,6 +186,74 @@ void basic_texture::generate()
 
 
 
+////////////////////////////////////////////////////////////////////////////////
+/// Texture
+////////////////////////////////////////////////////////////////////////////////
+
+texture::frame_type texture::current_frame{0};
+
+
+
+texture::size_type texture::size() const
+{
+	if (!valid()) return 0;
+
+	size_type result{0};
+	for (int level{0}; mipmap_levels > level; ++level)
+	{
+		size_type level_width = std::max(dimensions.x >> level, 1);
+		size_type level_height = std::max(dimensions.y >> level, 1);
+
+		// DXT5 stores each 4x4 block of texels in 16 bytes
+		if (has_compressed_format())
+			result += ((level_width + 3) / 4) * ((level_height + 3) / 4) * 16;
+		else
+			result += level_width * level_height * 4;
+	}
+	return result;
+}
+
+texture::size_type texture::uncompressed_size() const
+{
+	if (!valid()) return 0;
+
+	size_type result{0};
+	for (int level{0}; mipmap_levels > level; ++level)
+		result += static_cast<size_type>(std::max(dimensions.x >> level, 1)) 
+			* std::max(dimensions.y >> level, 1) * 4;
+	return result;
+}
+
+bool texture::drop_mipmap_level()
+{
+	if (!valid() || 1 >= mipmap_levels) return false;
+	if (!GLEW_ARB_texture_storage || !GLEW_ARB_copy_image) return false;
+
+	glm::ivec2 reduced_dimensions{
+		std::max(dimensions.x >> 1, 1), 
+		std::max(dimensions.y >> 1, 1)};
+
+	basic_texture reduced{target, filter::mipmap, wrap::repeat};
+	glTexStorage2D(target, mipmap_levels - 1, format, reduced_dimensions.x, reduced_dimensions.y);
+
+	// Level n + 1 of the old storage becomes level n of the new storage
+	for (int level{0}; mipmap_levels - 1 > level; ++level)
+		glCopyImageSubData(
+			id, target, level + 1, 0, 0, 0,
+			reduced.id, target, level, 0, 0, 0,
+			std::max(reduced_dimensions.x >> level, 1),
+			std::max(reduced_dimensions.y >> level, 1),
+			1);
+
+	// The old storage is released when reduced goes out of scope
+	swap(static_cast<basic_texture&>(*this), reduced);
+	dimensions = reduced_dimensions;
+	--mipmap_levels;
+	return true;
+}
+
+
+
 ////////////////////////////////////////////////////////////////////////////////
 /// Basic Texture Buffer
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,62 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/gpu/timer_query.hpp>
+
+#include <cstdint>
+
+#include <GL/glew.h>
+
+
+
+namespace black_label {
+namespace rendering {
+namespace gpu {
+
+unsigned int timer_query::current_frame{0};
+
+timer_query::~timer_query()
+{
+	for (auto& frame : frames)
+		if (!frame.queries.empty())
+			glDeleteQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+}
+
+void timer_query::record()
+{
+	auto& frame = frames[current_frame % latency];
+	if (current_frame != frame.number) {
+		collect(frame);
+		frame.number = current_frame;
+		frame.used = 0;
+	}
+
+	if (frame.queries.size() == frame.used) {
+		id_type query;
+		glGenQueries(1, &query);
+		frame.queries.push_back(query);
+	}
+
+	glQueryCounter(frame.queries[frame.used++], GL_TIMESTAMP);
+}
+
+void timer_query::collect( frame& frame )
+{
+	if (2 > frame.used) return;
+
+	// The queries complete in order
+	GLint available;
+	glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (GL_FALSE == available) return;
+
+	std::uint64_t sum{0};
+	for (std::size_t query{0}; frame.used > query + 1; query += 2) {
+		GLuint64 begin, end;
+		glGetQueryObjectui64v(frame.queries[query], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[query + 1], GL_QUERY_RESULT, &end);
+		sum += end - begin;
+	}
+	gpu_time = std::chrono::nanoseconds{sum};
+}
+
+} // namespace gpu
+} // namespace rendering
+} // namespace black_label
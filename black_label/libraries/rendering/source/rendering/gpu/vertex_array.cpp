@@ -1,5 +1,6 @@
 #define BLACK_LABEL_SHARED_LIBRARY_EXPORT
 #include <black_label/rendering/gpu/vertex_array.hpp>
+#include <black_label/rendering/gpu/state_cache.hpp>
 
 #include <GL/glew.h>
 
@@ -13,13 +14,17 @@ void vertex_array::generate()
 { glGenVertexArrays(1, &id); }
 
 vertex_array::~vertex_array()
-{ if (valid()) glDeleteVertexArrays(1, &id); }
+{
+	if (!valid()) return;
+	state_cache::get().forget_vertex_array(id);
+	glDeleteVertexArrays(1, &id);
+}
 
 void vertex_array::bind() const
-{ glBindVertexArray(id); }
+{ state_cache::get().bind_vertex_array(id); }
 
 void vertex_array::unbind()
-{ glBindVertexArray(0); }
+{ state_cache::get().bind_vertex_array(0); }
 
 void vertex_array::add_attribute( index_type& index, int size, const void* offset ) const
 {
@@ -0,0 +1,110 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/indirect_draws.hpp>
+#include <black_label/rendering/visibility.hpp>
+#include <black_label/utility/algorithm.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+#include <GL/glew.h>
+
+
+
+namespace black_label {
+namespace rendering {
+
+using namespace std;
+using namespace gpu;
+
+
+
+indirect_draws::indirect_draws()
+	: command_buffer{target::draw_indirect, usage::stream_draw}
+	, draw_buffer{target::shader_storage, usage::stream_draw}
+{}
+
+bool indirect_draws::is_supported()
+{ return GLEW_ARB_multi_draw_indirect ? true : false; }
+
+void indirect_draws::update( const instance_batches& batches, const visibility& visibility )
+{
+	auto key = [] ( const draw& draw ) { return draw.key; };
+
+	draws.clear();
+	for (int batch{0}; static_cast<int>(batches.batches.size()) > batch; ++batch)
+		for (const auto& mesh : batches.batches[batch].model->meshes)
+			if (mesh.geometry) {
+				auto texture_id = [] ( const auto& texture ) { return texture ? texture->id : 0u; };
+				draws.push_back({&mesh, batch, 0, make_state_key(mesh.geometry->arena->format, mesh.draw_mode, 
+					texture_id(mesh.diffuse), texture_id(mesh.specular))});
+			}
+	utility::radix_sort(draws, draw_sort_buffer, key);
+
+	// Keys may collide so groups compare the state itself
+	auto state = [] ( const draw& draw ) {
+		return make_tuple(draw.mesh->geometry->arena, static_cast<draw_mode::type>(draw.mesh->draw_mode),
+			draw.mesh->diffuse.get(), draw.mesh->specular.get());
+	};
+	groups.clear();
+	for (auto draw = draws.begin(); draws.end() != draw; ++draw) {
+		if (draws.begin() == draw || state(*draw) != state(*(draw - 1)))
+			groups.push_back({draw->mesh->geometry->arena, draw->mesh->draw_mode, draw->mesh, static_cast<int>(draw - draws.begin()), 0});
+		++groups.back().count;
+		draw->group = static_cast<int>(groups.size()) - 1;
+	}
+
+	commands.clear();
+	draw_instance_offsets.clear();
+	for (int view_index{0}; static_cast<int>(visibility.views.size()) > view_index; ++view_index) {
+		auto ranges = visibility.get_ranges(view_index);
+
+		// By group and then front to back by the nearest visible instance of
+		// the batch
+		sorted_draws.assign(draws.cbegin(), draws.cend());
+		for (auto& draw : sorted_draws)
+			draw.key = make_sort_key(static_cast<uint32_t>(draw.group), ranges[draw.batch].depth_key);
+		utility::radix_sort(sorted_draws, draw_sort_buffer, key);
+
+		for (const auto& draw : sorted_draws) {
+			const auto& geometry = *draw.mesh->geometry;
+			const auto& range = ranges[draw.batch];
+			commands.push_back({geometry.index_count, static_cast<unsigned int>(range.count), geometry.first_index, geometry.base_vertex, 0});
+			draw_instance_offsets.push_back(range.offset);
+		}
+	}
+
+	if (commands.empty()) return;
+	command_buffer.bind_and_update(static_cast<buffer::size_type>(commands.size() * sizeof(command)), commands.data());
+	draw_buffer.bind_and_update(static_cast<buffer::size_type>(draw_instance_offsets.size() * sizeof(int)), draw_instance_offsets.data());
+}
+
+void indirect_draws::render(
+	const core_program& program,
+	unsigned int draw_offset_location,
+	const material_uniforms* materials,
+	unsigned int texture_unit,
+	int view_index ) const
+{
+	command_buffer.bind();
+	auto view_offset = view_index * static_cast<int>(draws.size());
+
+	for (auto group = groups.cbegin(); groups.cend() != group;) {
+		auto last = group + 1;
+		if (materials)
+			group->material->use_material(program, *materials, texture_unit);
+		else // Without materials, all groups of the same geometry are merged
+			while (groups.cend() != last && group->has_same_geometry(*last)) ++last;
+
+		auto count = (last - 1)->first + (last - 1)->count - group->first;
+		group->arena->bind();
+		auto first = view_offset + group->first;
+		program.set_uniform(draw_offset_location, first);
+		glMultiDrawElementsIndirect(group->draw_mode, GL_UNSIGNED_INT,
+			reinterpret_cast<const void*>(first * sizeof(command)), count, 0);
+
+		group = last;
+	}
+}
+
+} // namespace rendering
+} // namespace black_label
@@ -36,6 +36,13 @@ void initialize()
 
 	if (GLEW_ARB_texture_storage)
 		glHint(GL_GENERATE_MIPMAP_HINT, GL_NICEST);
+
+#ifdef GL_KHR_parallel_shader_compile
+	// Lets the driver compile and link on as many threads as it sees fit
+	if (GLEW_KHR_parallel_shader_compile)
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+#endif
+
 	glEnable(GL_FRAMEBUFFER_SRGB);
 }
 
@@ -1,7 +1,9 @@
 #define BLACK_LABEL_SHARED_LIBRARY_EXPORT
 #include <black_label/rendering/pipeline.hpp>
 
+#include <cmath>
 #include <random>
+#include <unordered_set>
 
 #include <boost/log/trivial.hpp>
 #include <boost/property_tree/json_parser.hpp>
@@ -24,6 +26,34 @@ using namespace boost::property_tree;
 namespace black_label {
 namespace rendering {
 
+namespace {
+
+// The previous resource of the name if it is still alive and predicate holds
+// for it; otherwise nullptr
+template<typename resource, typename predicate_type>
+shared_ptr<resource> find_reusable( const resource_map<resource>& previous, const string& name, predicate_type predicate )
+{
+	auto result = previous.find(name);
+	if (previous.cend() == result) return nullptr;
+	auto resource_ = result->second.lock();
+	return (resource_ && predicate(*resource_)) ? resource_ : nullptr;
+}
+
+string make_key( const program::configuration& configuration )
+{
+	auto key = configuration.path_to_vertex_shader_.string() + "\n"
+		+ configuration.path_to_geometry_shader_.string() + "\n"
+		+ configuration.path_to_fragment_shader_.string() + "\n"
+		+ configuration.preprocessor_commands_ + "\n";
+	for (const auto& name : configuration.vertex_attribute_names_) key += "in " + name + "\n";
+	for (const auto& name : configuration.fragment_output_names_) key += "out " + name + "\n";
+	return key;
+}
+
+} // namespace
+
+
+
 void pipeline::reload_shadow_mapping() {
 	auto vertex_file = shader_directory / "null.vertex.glsl";
 	auto fragment_file = shader_directory / "null.fragment.glsl";
@@ -34,7 +64,7 @@ void pipeline::reload_shadow_mapping() {
 		add_program(program::configuration()
 			.vertex_shader(shader_directory / "null.vertex.glsl")
 			.fragment_shader(shader_directory / "null.fragment.glsl")
-			.preprocessor_commands("#version 330\n")),
+			.preprocessor_commands("#version 430\n")),
 		GL_DEPTH_BUFFER_BIT,
 		GL_BACK,
 		render_mode{}
@@ -47,6 +77,21 @@ bool pipeline::import( path pipeline_file )
 {
 	BOOST_LOG_TRIVIAL(info) << "Importing pipeline file " << pipeline_file << "...";
 
+	// The previous passes keep their programs, textures and buffers alive
+	// until the end of import such that unchanged ones are reused instead of
+	// recompiled or reallocated (see add_program and find_reusable)
+	auto previous_passes = move(passes);
+	auto previous_textures = move(textures);
+	auto previous_buffers = move(buffers);
+	auto previous_index_bound_buffers = move(index_bound_buffers);
+	// Aliased names refer to the allocation of another texture
+	for (const auto& alias : graph.aliases)
+		previous_textures.erase(alias.first);
+	// Forget the programs that are no longer used
+	for (auto entry = program_cache.begin(); program_cache.end() != entry;)
+		if (entry->second.expired()) entry = program_cache.erase(entry);
+		else ++entry;
+
 	programs.clear();
 	textures.clear();
 	views.clear();
@@ -54,6 +99,7 @@ bool pipeline::import( path pipeline_file )
 	index_bound_buffers.clear();
 	buffers_to_reset_pre_first_frame.clear();
 	passes.clear();
+	graph = render_graph{};
 	data_offsets = make_shared<std::vector<glm::uvec4>>();
 
 	try {
@@ -71,6 +117,10 @@ bool pipeline::import( path pipeline_file )
 			return glm::vec3(x, y, z);
 		};
 
+		// In milliseconds. Scalable passes keep their largest scale without it.
+		auto target_frame_time = root.get<float>("target_frame_time", 0.0f);
+		governor = frame_time_governor{chrono::duration_cast<chrono::nanoseconds>(chrono::duration<float, milli>{target_frame_time})};
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -171,6 +221,10 @@ bool pipeline::import( path pipeline_file )
 			allocated_views.emplace_back(name, view);
 			views.emplace(name, view);
 
+			// The heads of all layered depth maps come first in data_buffer
+			auto data_offset = data_offsets->empty() ? 0u : data_offsets->back()[0] + static_cast<unsigned int>(ldm_size * ldm_size);
+			data_offsets->emplace_back(data_offset, 0u, 0u, 0u);
+
 			++ldm_view_count;
 		}
 
@@ -180,6 +234,8 @@ bool pipeline::import( path pipeline_file )
 /// Textures
 ////////////////////////////////////////////////////////////////////////////////
 		pass::texture_container allocated_textures;
+		// Not rendered to
+		unordered_set<string> data_textures;
 
 		for (auto child : root.get_child("textures"))
 		{
@@ -213,9 +269,21 @@ bool pipeline::import( path pipeline_file )
 			auto width = texture_ptree.get<float>("width", 1.0);
 			auto height = texture_ptree.get<float>("height", 1.0);
 
-			auto texture = make_shared<gpu::storage_texture>(target::texture_2d, format, filter, wrap, width, height);
+			shared_ptr<gpu::storage_texture> texture;
+			if (!data)
+				texture = find_reusable(previous_textures, name, [&] ( const gpu::storage_texture& previous ) {
+					return target::texture_2d == previous.target
+						&& format == previous.format
+						&& filter == previous.filter
+						&& wrap == previous.wrap
+						&& width == previous.width
+						&& height == previous.height;
+				});
+			if (!texture)
+				texture = make_shared<gpu::storage_texture>(target::texture_2d, format, filter, wrap, width, height);
 
 			if (data) {
+				data_textures.insert(name);
 				if ("random" == *data) {
 					mt19937 random_number_generator;
 					uniform_real_distribution<float> distribution(-1.0f, 1.0f);
@@ -270,14 +338,26 @@ bool pipeline::import( path pipeline_file )
 				else throw exception{"Unknown data type."};
 			}
 
+			// The contents of a reused buffer are only as expected if it is reset
+			auto reusable = [&] ( const gpu::buffer& previous ) {
+				return (!data_name || reset_name)
+					&& target == previous.target
+					&& size <= previous.allocated_size;
+			};
+
 			shared_ptr<gpu::buffer> buffer;
 			if (binding) {
-				auto index_bound_buffer = make_shared<gpu::index_bound_buffer>(target, usage::dynamic_copy, *binding, size, (data.empty()) ? nullptr : data.data());
+				auto index_bound_buffer = find_reusable(previous_index_bound_buffers, name, [&] ( const gpu::index_bound_buffer& previous )
+					{ return static_cast<gpu::buffer::index_type>(*binding) == previous.index && reusable(previous); });
+				if (!index_bound_buffer)
+					index_bound_buffer = make_shared<gpu::index_bound_buffer>(target, usage::dynamic_copy, *binding, size, (data.empty()) ? nullptr : data.data());
 				allocated_index_bound_buffers.emplace_back(name, index_bound_buffer);
 				index_bound_buffers.emplace(name, index_bound_buffer);
 				buffer = index_bound_buffer;
 			} else {
-				buffer = make_shared<gpu::buffer>(target, usage::dynamic_copy, size, (data.empty()) ? nullptr : data.data());
+				buffer = find_reusable(previous_buffers, name, reusable);
+				if (!buffer)
+					buffer = make_shared<gpu::buffer>(target, usage::dynamic_copy, size, (data.empty()) ? nullptr : data.data());
 				allocated_buffers.emplace_back(name, buffer);
 				buffers.emplace(name, buffer);
 			}
@@ -295,12 +375,124 @@ bool pipeline::import( path pipeline_file )
 ////////////////////////////////////////////////////////////////////////////////
 /// Passes
 ////////////////////////////////////////////////////////////////////////////////
+		// Built-in passes that resample the textures of passes that render at a
+		// fraction of the resolution. They write depth outputs if any.
+		auto add_resampling_pass = [&] (
+			string name,
+			const string& fragment_program,
+			const string& preprocessor_commands,
+			pass::texture_container input_textures,
+			pass::texture_container output_textures,
+			unordered_map<string, string> texture_names,
+			const black_label::rendering::view* view )
+		{
+			auto has_depth_output = boost::algorithm::any_of(output_textures, [] ( const auto& entry )
+				{ return entry.second->has_depth_format(); });
+
+			program::configuration configuration;
+			configuration.vertex_shader(shader_directory / "pass-through.vertex.glsl");
+			configuration.fragment_shader(shader_directory / fragment_program);
+			configuration.preprocessor_commands("#version 430\n" + preprocessor_commands);
+			for (const auto& output_textures_value : output_textures)
+				if (!output_textures_value.second->has_depth_format())
+					configuration.add_fragment_output(output_textures_value.first);
+
+			render_mode render_mode;
+			render_mode.set(render_mode::screen_aligned_quad);
+			render_mode.set(render_mode::test_depth, has_depth_output);
+			unsigned int clearing_mask = has_depth_output ? GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT : 0u;
+
+			passes.emplace_back(
+				move(name),
+				add_program(configuration),
+				move(input_textures),
+				move(output_textures),
+				pass::view_container{},
+				pass::buffer_container{},
+				pass::index_bound_buffer_container{},
+				clearing_mask,
+				0u,
+				0u,
+				render_mode,
+				view,
+				user_view,
+				0,
+				ldm_view_count,
+				data_offsets);
+			passes.back().texture_names = move(texture_names);
+		};
+
 		for (auto pass_child : root.get_child("passes"))
 		{
 			auto pass_configuration = pass_child.second;
 			auto name = pass_configuration.get<string>("name");
 
 			if ("ldm_passes" == name) {
+				// All layered depth maps in one pass. The statics are culled against
+				// a view that bounds the views of all of them and are drawn once per
+				// view by instancing (see layer_count).
+				if (pass_configuration.get<bool>("layered", false)) {
+					if (0 == ldm_view_count) continue;
+
+					// The views are boxes of half size ldm_scale around eyes at unit
+					// distance from ldm_offset
+					auto bound = ldm_scale * sqrt(3.0f) + 1.0f;
+					auto bounds = make_shared<black_label::rendering::view>(
+						ldm_offset + glm::vec3{0.0f, 0.0f, 1.0f},
+						ldm_offset,
+						glm::vec3{0.0f, 1.0f, 0.0f},
+						ldm_size,
+						ldm_size,
+						-bound,
+						bound,
+						-bound,
+						bound,
+						-bound,
+						bound);
+					allocated_views.emplace_back("ldm_bounds", bounds);
+					views.emplace("ldm_bounds", bounds);
+
+					program::configuration configuration;
+					configuration.vertex_shader(shader_directory / "ldm.vertex.glsl");
+					configuration.fragment_shader(shader_directory / "ldm.fragment.glsl");
+					configuration.preprocessor_commands("#version 430\n#define LAYERED\n");
+
+					pass::view_container auxiliary_views;
+					for (int id{0}; ldm_view_count > id; ++id)
+						auxiliary_views.emplace_back("ldm_view" + to_string(id), views.at("ldm_view" + to_string(id)).lock());
+
+					pass::buffer_container pass_buffers;
+					pass::index_bound_buffer_container pass_index_bound_buffers;
+					pass_buffers.emplace_back("data_buffer", buffers.find("data_buffer")->second.lock());
+					pass_index_bound_buffers.emplace_back("counter", index_bound_buffers.at("counter").lock());
+
+					render_mode render_mode;
+					render_mode.set(render_mode::statics);
+					render_mode.set(render_mode::dynamics);
+					render_mode.set(render_mode::test_depth, false);
+					render_mode.set(render_mode::materials, pass_configuration.get<bool>("materials", true));
+
+					passes.emplace_back(
+						"ldm_views",
+						add_program(configuration),
+						pass::texture_container{},
+						pass::texture_container{},
+						move(auxiliary_views),
+						move(pass_buffers),
+						move(pass_index_bound_buffers),
+						0u,
+						GL_SHADER_STORAGE_BARRIER_BIT,
+						0u,
+						render_mode,
+						bounds.get(),
+						user_view,
+						static_cast<int>(data_offsets->back()[0]) + ldm_size * ldm_size,
+						ldm_view_count,
+						data_offsets);
+					passes.back().layer_count = ldm_view_count;
+					continue;
+				}
+
 				program::configuration configuration;
 				configuration.vertex_shader(shader_directory / "ldm.vertex.glsl");
 				configuration.fragment_shader(shader_directory / "ldm.fragment.glsl");
@@ -326,7 +518,8 @@ bool pipeline::import( path pipeline_file )
 					render_mode.set(render_mode::materials, pass_configuration.get<bool>("materials", true));
 
 					unsigned int post_memory_barrier_mask{GL_SHADER_STORAGE_BARRIER_BIT};
-					auto preincrement_buffer_counter = 40000;
+					// The first pass starts the counter after the heads
+					auto preincrement_buffer_counter = (0 == id) ? static_cast<int>(data_offsets->back()[0]) + ldm_size * ldm_size : 0;
 
 					pass::texture_container input_textures, output_textures;
 					pass::view_container auxiliary_views;
@@ -347,7 +540,8 @@ bool pipeline::import( path pipeline_file )
 						user_view,
 						preincrement_buffer_counter,
 						0,
-						data_offsets);
+						data_offsets,
+						(*data_offsets)[id][0]);
 				}
 				continue;
 			}
@@ -472,6 +666,136 @@ bool pipeline::import( path pipeline_file )
 			render_mode.set(render_mode::test_depth, pass_configuration.get<bool>("test_depth", false));
 			render_mode.set(render_mode::materials, pass_configuration.get<bool>("materials", true));
 
+			// Either true or the bounds of the render scale, e.g.,
+			// { "min": 0.5, "max": 1.0 }
+			auto min_render_scale = 1.0f, max_render_scale = 1.0f;
+			if (auto scalable = pass_configuration.get_child_optional("scalable")) {
+				if (!scalable->empty() || scalable->get_value<bool>(false)) {
+					min_render_scale = scalable->get<float>("min", 0.5f);
+					max_render_scale = scalable->get<float>("max", 1.0f);
+				}
+				if (!(0.0f < min_render_scale && min_render_scale <= max_render_scale && 1.0f >= max_render_scale))
+					throw exception{"Scalable bounds must satisfy 0 < min <= max <= 1."};
+				// The screen is not upsampled
+				if (output_textures.empty() && 1.0f != min_render_scale)
+					throw exception{("Pass \"" + name + "\" draws to the screen and cannot be scalable.").c_str()};
+			}
+
+			// A fraction of the resolution of the outputs. The full resolution
+			// inputs are downsampled by a pass before and the outputs upsampled
+			// by a pass after. The pass itself reads and writes textures at the
+			// resolution, e.g., depths_50 for 0.5, which its shaders know by the
+			// original names; see pass::texture_names.
+			auto resolution = pass_configuration.get<float>("resolution", 1.0f);
+			if (!(0.0f < resolution && 1.0f >= resolution))
+				throw exception{"Resolution must satisfy 0 < resolution <= 1."};
+			unordered_map<string, string> texture_names;
+			pass::texture_container upsampling_inputs, upsampling_outputs;
+			unordered_map<string, string> upsampling_texture_names;
+			string upsampling_preprocessor_commands;
+			if (1.0f != resolution) {
+				if (output_textures.empty())
+					throw exception{("Pass \"" + name + "\" draws to the screen and cannot have a resolution.").c_str()};
+				if (min_render_scale != max_render_scale)
+					throw exception{("Pass \"" + name + "\" cannot both be scalable and have a resolution.").c_str()};
+
+				auto suffix = "_" + to_string(lround(resolution * 100.0f));
+				// Allocated like texture but at the resolution
+				auto allocate_downsampled = [&] ( const string& name, const gpu::storage_texture& texture ) {
+					auto width = texture.width * resolution;
+					auto height = texture.height * resolution;
+					auto result = find_reusable(previous_textures, name, [&] ( const gpu::storage_texture& previous ) {
+						return texture.target == previous.target
+							&& texture.format == previous.format
+							&& texture.filter == previous.filter
+							&& texture.wrap == previous.wrap
+							&& width == previous.width
+							&& height == previous.height;
+					});
+					if (!result)
+						result = make_shared<gpu::storage_texture>(texture.target, texture.format, texture.filter, texture.wrap, width, height);
+					textures.emplace(name, result);
+					return result;
+				};
+
+				// Inputs. Ones that an earlier pass downsampled are reused. The
+				// resampling passes know their textures by generic names, e.g.,
+				// source_color_0; see downsample.fragment.glsl.
+				pass::texture_container downsampling_inputs, downsampling_outputs;
+				unordered_map<string, string> downsampling_texture_names;
+				string downsampling_preprocessor_commands;
+				int color_count{0};
+				for (auto& entry : input_textures) {
+					const auto& texture = *entry.second;
+					if (data_textures.count(entry.first) || 1.0f != texture.width || 1.0f != texture.height) continue;
+
+					auto downsampled_name = entry.first + suffix;
+					auto downsampled = textures.find(downsampled_name);
+					auto downsampled_texture = (textures.end() != downsampled) ? downsampled->second.lock() : nullptr;
+					if (!downsampled_texture) {
+						downsampled_texture = allocate_downsampled(downsampled_name, texture);
+						string input_name, output_name;
+						if (!texture.has_depth_format()) {
+							output_name = "color_" + to_string(color_count++);
+							input_name = "source_" + output_name;
+						} else if (downsampling_preprocessor_commands.empty()) {
+							downsampling_preprocessor_commands = "#define DEPTH\n";
+							output_name = "depth";
+							input_name = "source_depth";
+						} else
+							throw exception{("Pass \"" + name + "\" has more than one depth input to downsample.").c_str()};
+						downsampling_inputs.emplace_back(input_name, entry.second);
+						downsampling_outputs.emplace_back(output_name, downsampled_texture);
+						downsampling_texture_names.emplace(move(input_name), entry.first);
+						downsampling_texture_names.emplace(move(output_name), downsampled_name);
+					}
+
+					// The first depth input guides the upsampling
+					if (texture.has_depth_format() && upsampling_preprocessor_commands.empty()) {
+						upsampling_preprocessor_commands = "#define GUIDE\n";
+						upsampling_inputs.emplace_back("guide", entry.second);
+						upsampling_inputs.emplace_back("low_guide", downsampled_texture);
+						upsampling_texture_names.emplace("guide", entry.first);
+						upsampling_texture_names.emplace("low_guide", downsampled_name);
+					}
+
+					texture_names.emplace(entry.first, move(downsampled_name));
+					entry.second = move(downsampled_texture);
+				}
+				if (4 < color_count)
+					throw exception{("Pass \"" + name + "\" has more than four inputs to downsample.").c_str()};
+				if (!downsampling_outputs.empty())
+					add_resampling_pass(
+						name + "_downsampling",
+						"downsample.fragment.glsl",
+						downsampling_preprocessor_commands + "#define COLOR_COUNT " + to_string(color_count) + "\n",
+						move(downsampling_inputs),
+						move(downsampling_outputs),
+						move(downsampling_texture_names),
+						view);
+
+				// Outputs
+				if (4 < output_textures.size())
+					throw exception{("Pass \"" + name + "\" has more than four outputs to upsample.").c_str()};
+				int source_count{0};
+				for (auto& entry : output_textures) {
+					if (entry.second->has_depth_format())
+						throw exception{("Pass \"" + name + "\" has a depth output and cannot have a resolution.").c_str()};
+
+					auto downsampled_name = entry.first + suffix;
+					auto downsampled_texture = allocate_downsampled(downsampled_name, *entry.second);
+					auto index = to_string(source_count++);
+					upsampling_inputs.emplace_back("source_" + index, downsampled_texture);
+					upsampling_outputs.emplace_back("result_" + index, entry.second);
+					upsampling_texture_names.emplace("source_" + index, downsampled_name);
+					upsampling_texture_names.emplace("result_" + index, entry.first);
+
+					texture_names.emplace(entry.first, move(downsampled_name));
+					entry.second = move(downsampled_texture);
+				}
+				upsampling_preprocessor_commands += "#define SOURCE_COUNT " + to_string(source_count) + "\n";
+			}
+
 			program::configuration configuration;
 			configuration.vertex_shader(shader_directory / vertex_program);
 			if (!geometry_program.empty()) 
@@ -502,7 +826,27 @@ bool pipeline::import( path pipeline_file )
 				preincrement_buffer_counter,
 				ldm_view_count,
 				data_offsets);
+			passes.back().texture_names = move(texture_names);
+			passes.back().min_render_scale = min_render_scale;
+			passes.back().max_render_scale = max_render_scale;
+			passes.back().render_scale = max_render_scale;
+
+			if (!upsampling_outputs.empty())
+				add_resampling_pass(
+					passes.back().name + "_upsampling",
+					"bilateral_upsample.fragment.glsl",
+					move(upsampling_preprocessor_commands),
+					move(upsampling_inputs),
+					move(upsampling_outputs),
+					move(upsampling_texture_names),
+					view);
 		}
+
+		graph = render_graph{passes};
+		for (render_graph::index_type index{0}; passes.size() > index; ++index)
+			if (graph.is_culled(index))
+				BOOST_LOG_TRIVIAL(info) << "Culled pass \"" << passes[index].name << "\"; none of its outputs reach the screen.";
+		alias_textures();
 	} 
 	catch (const exception& exception)
 	{
@@ -518,39 +862,97 @@ bool pipeline::import( path pipeline_file )
 	return complete = true;
 }
 
+void pipeline::alias_textures()
+{
+	for (const auto& alias : graph.aliases) {
+		BOOST_LOG_TRIVIAL(info) << "Texture \"" << alias.first << "\" shares the allocation of \"" << alias.second << "\".";
+		textures[alias.first] = textures.at(alias.second);
+	}
+
+	auto resolve = [this] ( const pass& pass, pass::texture_container& textures_ ) {
+		for (auto& entry : textures_) {
+			const auto& name = pass.texture_name(entry.first);
+			if (graph.aliases.count(name))
+				entry.second = textures.at(name).lock();
+		}
+	};
+
+	for (auto& pass : passes) {
+		resolve(pass, pass.input_textures);
+		resolve(pass, pass.output_textures);
+	}
+}
+
 bool pipeline::reload_program( path program_file )
 {
 	// Look up path to find the associated programs
 	auto program_range = programs.equal_range(program_file);
 	if (program_range.first == program_range.second) return false;
 
-	// Reload each associated program
+	// Reload each associated program. Collected first since the reloaded
+	// programs may include other files and are thus associated anew.
+	std::vector<std::shared_ptr<program>> associated_programs;
 	for (auto entry = program_range.first; program_range.second != entry; ++entry) {
 		auto program = entry->second.lock();
 		if (!program) assert(false);
+		associated_programs.push_back(program);
+	}
+
+	for (const auto& program : associated_programs) {
 		program->reload(program_file);
+		associate_files(program);
 	}
 
 	return true;
 }
 
+void pipeline::associate_files( const std::shared_ptr<program>& program_ )
+{
+	for (const auto& file : program_->get_files()) {
+		auto range = programs.equal_range(file);
+		auto is_associated = std::any_of(range.first, range.second, [&program_] ( const auto& entry )
+			{ return entry.second.lock() == program_; });
+		if (!is_associated) programs.emplace(file, program_);
+	}
+}
+
 std::shared_ptr<program> pipeline::add_program( program::configuration configuration )
 {
-	auto program_ = make_shared<program>(configuration.shader_directory(shader_directory));
+	configuration.shader_directory(shader_directory);
+
+	// Programs are kept up to date by reload_program so one with the same
+	// configuration is as good as a new one
+	auto& cached_program = program_cache[make_key(configuration)];
+	auto program_ = cached_program.lock();
+	auto is_cached = program_ && (program_->is_pending() || program_->is_complete());
+	if (!is_cached) {
+		program_ = make_shared<program>(configuration);
+		cached_program = program_;
+	}
 		
-	if (!configuration.path_to_vertex_shader_.empty())
-		programs.insert({configuration.path_to_vertex_shader_, program_});
-	if (!configuration.path_to_geometry_shader_.empty())
-		programs.insert({configuration.path_to_geometry_shader_, program_});
-	if (!configuration.path_to_fragment_shader_.empty())
-		programs.insert({configuration.path_to_fragment_shader_, program_});
+	associate_files(program_);
 
-	auto info_log = program_->get_aggregated_info_log();
-	if (!info_log.empty()) BOOST_LOG_TRIVIAL(warning) << info_log;
+	if (!is_cached)
+		unreported_programs.push_back(program_);
 
 	return program_;
 }
 
+void pipeline::report_programs()
+{
+	for (auto entry = unreported_programs.begin(); unreported_programs.end() != entry;) {
+		auto program_ = entry->lock();
+		if (program_ && program_->is_pending()) { ++entry; continue; }
+
+		if (program_) {
+			program_->update_binary_cache();
+			auto info_log = program_->get_aggregated_info_log();
+			if (!info_log.empty()) BOOST_LOG_TRIVIAL(warning) << info_log;
+		}
+		entry = unreported_programs.erase(entry);
+	}
+}
+
 
 
 } // namespace rendering
@@ -2,7 +2,13 @@
 #include <black_label/rendering/program.hpp>
 
 #include <black_label/file_buffer.hpp>
+#include <black_label/rendering/gpu/state_cache.hpp>
 
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
 #include <sstream>
 
 #include <boost/log/trivial.hpp>
@@ -17,6 +23,10 @@
 #include <OpenGL/gl.h>
 #endif
 
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 
 
 namespace black_label {
@@ -24,6 +34,104 @@ namespace rendering {
 
 using std::string;
 
+namespace {
+
+// Prepended to the source code of every shader
+const string& get_numerical_constants()
+{
+	static const string numerical_constants = [] {
+		std::stringstream numerical_constants_stream;
+		numerical_constants_stream << "#define PI " 
+			<< boost::math::constants::pi<float>() << std::endl;
+		return numerical_constants_stream.str();
+	}();
+	return numerical_constants;
+}
+
+// 64-bit FNV-1a. Unlike std::hash, it is the same for every run and build.
+const std::uint64_t hash_offset_basis{14695981039346656037ull};
+
+std::uint64_t hash( const char* data, std::size_t size, std::uint64_t result = hash_offset_basis )
+{
+	for (std::size_t i{0}; size > i; ++i) {
+		result ^= static_cast<unsigned char>(data[i]);
+		result *= 1099511628211ull;
+	}
+	return result;
+}
+
+// Includes the null terminator such that consecutive strings are delimited
+std::uint64_t hash( const string& value, std::uint64_t result = hash_offset_basis )
+{ return hash(value.c_str(), value.size() + 1, result); }
+
+bool has_parallel_shader_compile()
+{
+#ifdef GL_KHR_parallel_shader_compile
+	return GLEW_KHR_parallel_shader_compile;
+#else
+	return false;
+#endif
+}
+
+// The file name of an #include "file" directive. Empty if line is none.
+string parse_include( const string& line )
+{
+	auto first = line.find_first_not_of(" \t");
+	if (string::npos == first || 0 != line.compare(first, 8, "#include")) return string{};
+
+	auto opening_quote = line.find('"', first + 8);
+	if (string::npos == opening_quote) return string{};
+	auto closing_quote = line.find('"', opening_quote + 1);
+	if (string::npos == closing_quote) return string{};
+
+	return line.substr(opening_quote + 1, closing_quote - opening_quote - 1);
+}
+
+// Appends file to source with its includes expanded (see shader). #line
+// directives keep the line numbers of the info log right.
+bool expand_includes( const path& file, int source_string_number, string& source, std::vector<path>& dependencies )
+{
+	file_buffer::file_buffer file_contents(file.string());
+	if (!file_contents.data()) return false;
+
+	std::istringstream lines{string{file_contents.data(), file_contents.size()}};
+	string line;
+	for (int line_number{1}; std::getline(lines, line); ++line_number)
+	{
+		auto name = parse_include(line);
+		if (name.empty()) {
+			source += line;
+			source += '\n';
+			continue;
+		}
+
+		path included{name};
+		// Left in place such that compilation fails
+		if (!try_canonical_and_preferred(included, file.parent_path())) {
+			BOOST_LOG_TRIVIAL(warning) << "Could not find \"" << name << "\" included by " << file << ".";
+			source += line;
+			source += '\n';
+			continue;
+		}
+
+		// Already included; an empty line keeps the line numbers
+		if (dependencies.cend() != std::find(dependencies.cbegin(), dependencies.cend(), included)) {
+			source += '\n';
+			continue;
+		}
+
+		dependencies.push_back(included);
+		auto included_source_string_number = 2 + static_cast<int>(dependencies.size());
+		source += "#line 1 " + std::to_string(included_source_string_number) + "\n";
+		expand_includes(included, included_source_string_number, source, dependencies);
+		source += "#line " + std::to_string(line_number + 1) + " " + std::to_string(source_string_number) + "\n";
+	}
+
+	return true;
+}
+
+} // namespace
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,53 +140,74 @@ using std::string;
 shader::shader( 
 	shader_type type, 
 	const path& path_to_shader, 
-	const string& preprocessor_commands )
-	: type(type)
+	const string& preprocessor_commands,
+	bool compile_now )
+	: id(invalid_id)
+	, is_compile_status_queried(true)
+	, type(type)
 	, preprocessor_commands(preprocessor_commands)
 	, path_to_shader(path_to_shader)
+	, source_hash(0)
 {
-	load();
+	preprocess();
+	if (compile_now) compile();
 }
 
 BLACK_LABEL_SHARED_LIBRARY shader::~shader() 
 { 
-	if (id) glDeleteShader(id);
+	if (invalid_id != id) glDeleteShader(id);
 }
 
-void shader::load()
+void shader::preprocess()
 {
 	status.reset();
 	status.set(is_tried_instantiated_bit);
+	is_compile_status_queried = true;
+	source.clear();
+	dependencies.clear();
 
-	file_buffer::file_buffer 
-	source_code(path_to_shader.string(), file_buffer::null_terminated);
-	
-	if (!source_code.data())
-	{
-		id = invalid_id;
-		return;
-	}
+	if (!expand_includes(path_to_shader, 2, source, dependencies)) return;
 	status.set(shader_file_found_bit);
-	
-	// TODO: Do this without the following if statement.
-	static string numerical_constants;
-	if (numerical_constants.empty())
-	{
-		std::stringstream numerical_constants_stream;
-		numerical_constants_stream << "#define PI " 
-			<< boost::math::constants::pi<float>() << std::endl;
-		numerical_constants = numerical_constants_stream.str();
-	}
+
+	source_hash = hash(source, hash(get_numerical_constants(), hash(preprocessor_commands)));
+}
+
+void shader::compile()
+{
+	if (!is_shader_file_found()) return;
 
 	const GLchar* source_code_data[] = { 
 		preprocessor_commands.data(), 
-		numerical_constants.data(), 
-		source_code.data() };
+		get_numerical_constants().data(), 
+		source.data() };
 	
+	if (invalid_id != id) glDeleteShader(id);
 	id = glCreateShader(type);
 	glShaderSource(id, 3, source_code_data, nullptr);
 	glCompileShader(id);
-	
+	is_compile_status_queried = false;
+}
+
+bool shader::depends_on( const path& file ) const
+{
+	return file == path_to_shader
+		|| dependencies.cend() != std::find(dependencies.cbegin(), dependencies.cend(), file);
+}
+
+bool shader::is_pending() const
+{
+	if (is_compile_status_queried || !has_parallel_shader_compile()) return false;
+
+	GLint completion_status;
+	glGetShaderiv(id, GL_COMPLETION_STATUS_KHR, &completion_status);
+	return GL_FALSE == completion_status;
+}
+
+void shader::query_compile_status() const
+{
+	if (is_compile_status_queried) return;
+	is_compile_status_queried = true;
+
 	GLint compile_status;
 	glGetShaderiv(id, GL_COMPILE_STATUS, &compile_status);
 	if (compile_status)
@@ -116,14 +245,18 @@ namespace interface {
 ////////////////////////////////////////////////////////////////////////////////
 /// Core Program
 ////////////////////////////////////////////////////////////////////////////////
-core_program::core_program( generate_type ) : id(glCreateProgram()) {}
+core_program::core_program( generate_type ) : id(glCreateProgram()), is_reflected(true) {}
 
 core_program::~core_program()
-{ if (id) glDeleteProgram(id); }
+{
+	if (!id) return;
+	gpu::state_cache::get().forget_program(id);
+	glDeleteProgram(id);
+}
 
 
 
-void core_program::use() const { glUseProgram(id); }
+void core_program::use() const { gpu::state_cache::get().use_program(id); }
 
 void core_program::set_output_location( unsigned int location, const string& name )
 { glBindFragDataLocation(id, location, name.data()); }
@@ -131,20 +264,143 @@ void core_program::set_output_location( unsigned int location, const string& nam
 void core_program::set_attribute_location( unsigned int location, const string& name )
 { glBindAttribLocation(id, location, name.data()); }
     
-void core_program::link() const
-{ glLinkProgram(id); }
+void core_program::link()
+{ 
+	// Linking resets the values of the uniforms
+	gpu::state_cache::get().forget_program(id);
+	glLinkProgram(id); 
+	is_reflected = false;
+}
+
+bool core_program::link( unsigned int binary_format, const std::vector<char>& binary )
+{
+	gpu::state_cache::get().forget_program(id);
+	glProgramBinary(id, binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+	is_reflected = false;
+
+	GLint link_status;
+	glGetProgramiv(id, GL_LINK_STATUS, &link_status);
+	return GL_FALSE != link_status;
+}
+
+bool core_program::get_binary( unsigned int& binary_format, std::vector<char>& binary ) const
+{
+	GLint length;
+	glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (0 >= length) return false;
+
+	binary.resize(length);
+	GLenum format;
+	glGetProgramBinary(id, length, nullptr, &format, binary.data());
+	binary_format = format;
+	return true;
+}
+
+bool core_program::is_pending() const
+{
+	if (!has_parallel_shader_compile()) return false;
 
+	GLint completion_status;
+	glGetProgramiv(id, GL_COMPLETION_STATUS_KHR, &completion_status);
+	return GL_FALSE == completion_status;
+}
+
+void core_program::reflect() const
+{
+	if (is_reflected) return;
+	is_reflected = true;
 
+	uniforms.clear();
+	uniform_blocks.clear();
+	shader_storage_blocks.clear();
 
+	GLint link_status;
+	glGetProgramiv(id, GL_LINK_STATUS, &link_status);
+	if (GL_FALSE == link_status) return;
+
+	GLint count, max_length;
+	string name;
+
+	// Uniforms (excluding the members of uniform blocks)
+	glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+	name.resize(max_length);
+	for (GLint i{0}; count > i; ++i)
+	{
+		GLsizei length;
+		GLint size;
+		GLenum type;
+		glGetActiveUniform(id, i, max_length, &length, &size, &type, &name[0]);
+		string uniform_name{name.data(), static_cast<string::size_type>(length)};
+
+		auto location = glGetUniformLocation(id, uniform_name.data());
+		if (-1 == location) continue;
+
+		uniform_info info{static_cast<unsigned int>(location), type, size};
+		uniforms.emplace(uniform_name, info);
+		// Arrays are reported as "name[0]" but are also accessible as "name"
+		auto array_suffix = uniform_name.rfind("[0]");
+		if (string::npos != array_suffix && uniform_name.size() - 3 == array_suffix)
+			uniforms.emplace(uniform_name.substr(0, array_suffix), info);
+	}
+
+	// Uniform blocks
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+	glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_length);
+	name.resize(max_length);
+	for (GLint i{0}; count > i; ++i)
+	{
+		GLsizei length;
+		glGetActiveUniformBlockName(id, i, max_length, &length, &name[0]);
+		uniform_blocks.emplace(string{name.data(), static_cast<string::size_type>(length)}, i);
+	}
+
+	// Shader storage blocks
+	if (!GLEW_ARB_program_interface_query) return;
+	glGetProgramInterfaceiv(id, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &count);
+	glGetProgramInterfaceiv(id, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &max_length);
+	name.resize(max_length);
+	for (GLint i{0}; count > i; ++i)
+	{
+		GLsizei length;
+		glGetProgramResourceName(id, GL_SHADER_STORAGE_BLOCK, i, max_length, &length, &name[0]);
+		shader_storage_blocks.emplace(string{name.data(), static_cast<string::size_type>(length)}, i);
+	}
+}
+
+
+
+const core_program::uniform_info* core_program::find_uniform( const string& name ) const
+{
+	reflect();
+	auto uniform = uniforms.find(name);
+	return (uniforms.end() != uniform) ? &uniform->second : nullptr;
+}
 unsigned int core_program::get_uniform_location( const string& name ) const
-{ return glGetUniformLocation(id, name.data()); }
+{
+	auto uniform = find_uniform(name);
+	return (uniform) ? uniform->location : invalid_location;
+}
 unsigned int core_program::get_uniform_block_index( const string& name ) const
-{ return glGetUniformBlockIndex(id, name.data()); }
+{
+	reflect();
+	auto block = uniform_blocks.find(name);
+	return (uniform_blocks.end() != block) ? block->second : invalid_location;
+}
 unsigned int core_program::get_resource_index( interface::type interface, const string& name ) const
-{ return glGetProgramResourceIndex(id, interface, name.data()); }
+{
+	if (interface::shader_storage_block == interface)
+	{
+		reflect();
+		auto block = shader_storage_blocks.find(name);
+		return (shader_storage_blocks.end() != block) ? block->second : invalid_location;
+	}
+	return glGetProgramResourceIndex(id, interface, name.data());
+}
 
+// Integer uniforms (e.g., samplers and flags) rarely change between draws
 void core_program::set_uniform( unsigned int location, int value ) const
-{ glUniform1i(location, value); }
+{ gpu::state_cache::get().set_uniform(id, location, value); }
 
 void core_program::set_uniform( unsigned int location, int value1, int value2 ) const
 { glUniform2i(location, value1, value2); }
@@ -188,6 +444,17 @@ void core_program::set_uniform_block( unsigned int index, unsigned int& binding_
 	glBindBufferBase(GL_UNIFORM_BUFFER, binding_point++, value);
 }
 
+void core_program::set_uniform_block( 
+	unsigned int index, 
+	unsigned int& binding_point, 
+	const gpu::buffer& value, 
+	gpu::buffer::offset_type offset, 
+	gpu::buffer::size_type size ) const
+{ 
+	glUniformBlockBinding(id, index, binding_point);
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding_point++, value, offset, size);
+}
+
 void core_program::set_shader_storage_block( unsigned int index, unsigned int& binding_point, const gpu::buffer& value ) const
 { 
 	glShaderStorageBlockBinding(id, index, binding_point);
@@ -199,27 +466,65 @@ void core_program::set_shader_storage_block( unsigned int index, unsigned int& b
 ////////////////////////////////////////////////////////////////////////////////
 /// Program
 ////////////////////////////////////////////////////////////////////////////////
+path program::binary_cache_directory;
+
+program::program( const configuration& configuration )
+	: core_program{black_label::rendering::generate}
+{
+	set_output_locations(
+		configuration.fragment_output_names_.cbegin(),
+		configuration.fragment_output_names_.cend());
+	set_attribute_locations(
+		configuration.vertex_attribute_names_.cbegin(),
+		configuration.vertex_attribute_names_.cend());
+
+	// The preprocessed shaders are part of the key of the binary cache
+	setup(
+		configuration.path_to_vertex_shader_, 
+		configuration.path_to_geometry_shader_, 
+		configuration.path_to_fragment_shader_, 
+		configuration.preprocessor_commands_,
+		false);
+
+	binary_path = get_binary_path(configuration);
+	// The shaders are not compiled but are remembered for reload
+	if (!binary_path.empty() && load_binary(binary_path)) {
+		binary_path.clear();
+		return;
+	}
+
+	compile_shaders();
+	if (!binary_path.empty())
+		glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	// The binary is stored by update_binary_cache once linked
+	link();
+}
+
 BLACK_LABEL_SHARED_LIBRARY program::~program()
 {
 	if (!id) return;
 
-	if (vertex.is_complete()) glDetachShader(id, vertex.id);
-	if (geometry.is_complete()) glDetachShader(id, geometry.id);
-	if (fragment.is_complete()) glDetachShader(id, fragment.id);
+	// See setup
+	for (const auto* shader_ : {&vertex, &geometry, &fragment})
+		if (shader::invalid_id != shader_->id) glDetachShader(id, shader_->id);
 }
 
 
 
 bool program::is_complete() const
 {
+	if (is_pending()) return false;
+
 	bool result = true;
 
-	if (vertex.is_tried_instantiated() && !vertex.is_complete())
-		result = false;
-	if (geometry.is_tried_instantiated() && !geometry.is_complete())
-		result = false;
-	if (fragment.is_tried_instantiated() && !fragment.is_complete())
-		result = false;
+	for (const auto* shader_ : {&vertex, &geometry, &fragment}) {
+		if (!shader_->is_tried_instantiated()) continue;
+		if (!shader_->is_shader_file_found())
+			result = false;
+		// Shaders of programs loaded from binaries are not compiled
+		else if (shader::invalid_id != shader_->id && !shader_->is_compiled())
+			result = false;
+	}
 
 	GLint link_status;
 	glGetProgramiv(id, GL_LINK_STATUS, &link_status);
@@ -230,55 +535,79 @@ bool program::is_complete() const
 }
 
 void program::reload( path program_file ) {
-	if (program_file == vertex.path_to_shader)
+	// A program loaded from a binary has no compiled shaders to relink with
+	if (vertex.is_shader_file_found() && shader::invalid_id == vertex.id)
 	{
 		BOOST_LOG_TRIVIAL(info) << "Reloading shader: " << program_file;
 
-		if (is_complete())
-			glDetachShader(id, vertex.id);
-
-		vertex.load();
-		
-		if (is_complete())
-		{
-			glAttachShader(id, vertex.id);
-			link();
-		}
+		setup(
+			vertex.path_to_shader, 
+			geometry.path_to_shader, 
+			fragment.path_to_shader, 
+			vertex.preprocessor_commands);
+		link();
 	}
-	else if (geometry.is_tried_instantiated() && program_file == geometry.path_to_shader)
+	else
 	{
-		BOOST_LOG_TRIVIAL(info) << "Reloading shader: " << program_file;
-
-		if (is_complete())
-			glDetachShader(id, geometry.id);
+		bool is_replaced{false};
+		for (auto* shader_ : {&vertex, &geometry, &fragment})
+			if (shader_->is_tried_instantiated() && shader_->depends_on(program_file))
+				is_replaced |= reload(*shader_);
+		if (!is_replaced) return;
+		link();
+	}
 
-		geometry.load();
+	auto info_log = get_aggregated_info_log();
+		if (!info_log.empty())
+			BOOST_LOG_TRIVIAL(warning) << info_log;
+}
 
-		if (is_complete())
-		{
-			glAttachShader(id, geometry.id);
-			link();
-		}
+std::vector<path> program::get_files() const
+{
+	std::vector<path> result;
+	for (const auto* shader_ : {&vertex, &geometry, &fragment}) {
+		if (!shader_->is_tried_instantiated()) continue;
+		result.push_back(shader_->path_to_shader);
+		result.insert(result.end(), shader_->dependencies.cbegin(), shader_->dependencies.cend());
 	}
-	else if (program_file == fragment.path_to_shader)
-	{
-		BOOST_LOG_TRIVIAL(info) << "Reloading shader: " << program_file;
+	return result;
+}
+
+void program::update_binary_cache()
+{
+	if (binary_path.empty()) return;
+	if (is_complete()) store_binary(binary_path);
+	binary_path.clear();
+}
 
-		if (is_complete())
-			glDetachShader(id, fragment.id);
+bool program::reload( shader& shader_ )
+{
+	shader replacement(shader_.type, shader_.path_to_shader, shader_.preprocessor_commands, false);
+	// E.g., a file that is included but whose changes are #ifdef'ed out
+	if (replacement.is_shader_file_found() && shader_.is_shader_file_found()
+		&& replacement.source_hash == shader_.source_hash)
+		return false;
 
-		fragment.load();
+	BOOST_LOG_TRIVIAL(info) << "Reloading shader: " << shader_.path_to_shader;
 
-		if (is_complete())
-		{
-			glAttachShader(id, fragment.id);
-			link();
-		}
-	}
+	// See setup
+	if (shader::invalid_id != shader_.id) glDetachShader(id, shader_.id);
+	shader_ = std::move(replacement);
+	shader_.compile();
+	if (shader::invalid_id != shader_.id) glAttachShader(id, shader_.id);
 
-	auto info_log = get_aggregated_info_log();
-		if (!info_log.empty())
-			BOOST_LOG_TRIVIAL(warning) << info_log;
+	return true;
+}
+
+void program::compile_shaders()
+{
+	for (auto* shader_ : {&vertex, &geometry, &fragment}) {
+		if (shader::invalid_id != shader_->id) continue;
+		shader_->compile();
+		// Attached without waiting for the compiler. A shader that fails to
+		// compile makes the link fail.
+		if (shader::invalid_id != shader_->id) glAttachShader(id, shader_->id);
+	}
 }
 
 std::string program::get_info_log() const
@@ -302,27 +631,30 @@ std::string program::get_aggregated_info_log() const
 	string result;
 
 	// Vertex
-	if (vertex.is_shader_file_found())
-		result += vertex.get_info_log();
-	else
-		result += "Vertex shader file was not found.\n";
+	if (vertex.is_tried_instantiated())
+	{
+		if (!vertex.is_shader_file_found())
+			result += "Vertex shader file was not found.\n";
+		else if (shader::invalid_id != vertex.id)
+			result += vertex.get_info_log();
+	}
 
 	// Geometry
 	if (geometry.is_tried_instantiated())
 	{
-		if (geometry.is_shader_file_found())
-			result += geometry.get_info_log();
-		else
+		if (!geometry.is_shader_file_found())
 			result += "Geometry shader file was not found.\n";
+		else if (shader::invalid_id != geometry.id)
+			result += geometry.get_info_log();
 	}
 
 	// Fragment
 	if (fragment.is_tried_instantiated())
 	{
-		if (fragment.is_shader_file_found())
-			result += fragment.get_info_log();
-		else
+		if (!fragment.is_shader_file_found())
 			result += "Fragment shader file was not found.\n";
+		else if (shader::invalid_id != fragment.id)
+			result += fragment.get_info_log();
 	}
 
 	// Program
@@ -331,23 +663,82 @@ std::string program::get_aggregated_info_log() const
 	return result;
 }
 
+path program::get_binary_path( const configuration& configuration ) const
+{
+	if (binary_cache_directory.empty() || !GLEW_ARB_get_program_binary) return path{};
+
+	// Everything that the linked program depends on. The source hashes cover
+	// the included files, the preprocessor commands and the numerical
+	// constants.
+	auto result = hash_offset_basis;
+	for (const auto* shader_ : {&vertex, &geometry, &fragment})
+	{
+		result = hash(shader_->path_to_shader.string(), result);
+		if (!shader_->is_tried_instantiated()) continue;
+		if (!shader_->is_shader_file_found()) return path{};
+		result = hash(reinterpret_cast<const char*>(&shader_->source_hash), sizeof(shader_->source_hash), result);
+	}
+	for (const auto& name : configuration.vertex_attribute_names_)
+		result = hash("in " + name, result);
+	for (const auto& name : configuration.fragment_output_names_)
+		result = hash("out " + name, result);
+	for (auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+		auto value = reinterpret_cast<const char*>(glGetString(name));
+		result = hash(string{value ? value : ""}, result);
+	}
+
+	std::stringstream file_name;
+	file_name << std::hex << std::setw(16) << std::setfill('0') << result << ".program";
+	return binary_cache_directory / file_name.str();
+}
+
+bool program::load_binary( const path& binary_path )
+{
+	std::ifstream file{binary_path.string(), std::ios::binary};
+	if (!file) return false;
+
+	std::uint32_t binary_format;
+	if (!file.read(reinterpret_cast<char*>(&binary_format), sizeof(binary_format))) return false;
+	std::vector<char> binary{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+	if (binary.empty()) return false;
+
+	// Falls back to compiling if the driver rejects the binary
+	return link(binary_format, binary);
+}
+
+void program::store_binary( const path& binary_path ) const
+{
+	unsigned int binary_format;
+	std::vector<char> binary;
+	if (!get_binary(binary_format, binary)) return;
+
+	system::error_code error_code;
+	create_directories(binary_path.parent_path(), error_code);
+
+	std::ofstream file{binary_path.string(), std::ios::binary | std::ios::trunc};
+	std::uint32_t binary_format_{binary_format};
+	file.write(reinterpret_cast<const char*>(&binary_format_), sizeof(binary_format_));
+	file.write(binary.data(), binary.size());
+	if (!file) BOOST_LOG_TRIVIAL(warning) << "Could not write the program binary " << binary_path << ".";
+}
+
 void program::setup(
 	const path& path_to_vertex_shader,
 	const path& path_to_geometry_shader,
 	const path& path_to_fragment_shader,
-	const string& preprocessor_commands)
+	const string& preprocessor_commands,
+	bool compile)
 {
-	vertex = shader(GL_VERTEX_SHADER, path_to_vertex_shader, preprocessor_commands);
-	if (!path_to_geometry_shader.empty())
-		geometry = shader(GL_GEOMETRY_SHADER, path_to_geometry_shader, preprocessor_commands);
-	if (!path_to_fragment_shader.empty())
-		fragment = shader(GL_FRAGMENT_SHADER, path_to_fragment_shader, preprocessor_commands);
+	for (const auto* shader_ : {&vertex, &geometry, &fragment})
+		if (shader::invalid_id != shader_->id) glDetachShader(id, shader_->id);
 
-	if (vertex.is_complete()) glAttachShader(id, vertex.id);
-	if (geometry.is_complete()) glAttachShader(id, geometry.id);
-	if (fragment.is_complete()) glAttachShader(id, fragment.id);
+	vertex = shader(GL_VERTEX_SHADER, path_to_vertex_shader, preprocessor_commands, false);
+	geometry = path_to_geometry_shader.empty()
+		? shader{} : shader(GL_GEOMETRY_SHADER, path_to_geometry_shader, preprocessor_commands, false);
+	fragment = path_to_fragment_shader.empty()
+		? shader{} : shader(GL_FRAGMENT_SHADER, path_to_fragment_shader, preprocessor_commands, false);
 
-	glValidateProgram(id);
+	if (compile) compile_shaders();
 }
 
 } // namespace rendering
@@ -0,0 +1,169 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/render_graph.hpp>
+
+#include <algorithm>
+
+#include <GL/glew.h>
+
+
+
+namespace black_label {
+namespace rendering {
+
+using namespace std;
+
+namespace {
+
+bool is_allocated_alike( const gpu::storage_texture& lhs, const gpu::storage_texture& rhs )
+{
+	return lhs.target == rhs.target
+		&& lhs.format == rhs.format
+		&& lhs.filter == rhs.filter
+		&& lhs.wrap == rhs.wrap
+		&& lhs.width == rhs.width
+		&& lhs.height == rhs.height;
+}
+
+} // namespace
+
+
+
+render_graph::render_graph( const vector<pass>& passes )
+{
+	compute_dependencies(passes);
+	compute_culled(passes);
+	compute_lifetimes(passes);
+	compute_aliases(passes);
+}
+
+void render_graph::compute_dependencies( const vector<pass>& passes )
+{
+	dependencies.assign(passes.size(), vector<index_type>{});
+	unordered_map<string, index_type> last_writers, last_users;
+
+	for (index_type index{0}; passes.size() > index; ++index) {
+		const auto& pass = passes[index];
+		auto& pass_dependencies = dependencies[index];
+
+		auto depend_on = [&pass_dependencies] ( index_type other ) {
+			if (pass_dependencies.cend() == find(pass_dependencies.cbegin(), pass_dependencies.cend(), other))
+				pass_dependencies.push_back(other);
+		};
+		auto use_buffers = [&] ( const auto& buffers ) {
+			for (const auto& entry : buffers) {
+				auto user = last_users.find(entry.first);
+				if (last_users.cend() != user) depend_on(user->second);
+				last_users[entry.first] = index;
+			}
+		};
+
+		for (const auto& entry : pass.input_textures) {
+			auto writer = last_writers.find(pass.texture_name(entry.first));
+			if (last_writers.cend() != writer) depend_on(writer->second);
+		}
+		use_buffers(pass.buffers);
+		use_buffers(pass.index_bound_buffers);
+
+		const unsigned int full_clearing_mask{GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT};
+		auto clears_outputs = full_clearing_mask == (pass.clearing_mask & full_clearing_mask);
+		for (const auto& entry : pass.output_textures) {
+			const auto& name = pass.texture_name(entry.first);
+			auto writer = last_writers.find(name);
+			if (!clears_outputs && last_writers.cend() != writer) depend_on(writer->second);
+			last_writers[name] = index;
+		}
+	}
+}
+
+void render_graph::compute_culled( const vector<pass>& passes )
+{
+	culled.assign(passes.size(), true);
+
+	// Dependencies point to earlier passes so one backward sweep suffices
+	for (auto index = passes.size(); 0 < index--;) {
+		const auto& pass = passes[index];
+		if (pass.output_textures.empty() || !pass.buffers.empty() || !pass.index_bound_buffers.empty())
+			culled[index] = false;
+		if (culled[index]) continue;
+
+		for (auto dependency : dependencies[index])
+			culled[dependency] = false;
+	}
+}
+
+void render_graph::compute_lifetimes( const vector<pass>& passes )
+{
+	lifetimes.clear();
+
+	for (index_type index{0}; passes.size() > index; ++index) {
+		if (culled[index]) continue;
+		const auto& pass = passes[index];
+
+		// Whether the pass leaves nothing of the previous contents of texture.
+		// Otherwise it may blend or depth test against them.
+		auto overwrites = [&pass] ( const gpu::storage_texture& texture ) {
+			if (pass.render_mode[render_mode::screen_aligned_quad]) return true;
+			auto clearing_bit = texture.has_depth_format() ? GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT;
+			return 0u != (pass.clearing_mask & clearing_bit);
+		};
+
+		// Inputs before outputs such that a pass that reads and writes a
+		// texture that is not yet written does not make it transient
+		for (const auto& entry : pass.input_textures) {
+			auto result = lifetimes.emplace(pass.texture_name(entry.first), lifetime{index, index, false});
+			if (!result.second) result.first->second.last = index;
+		}
+		for (const auto& entry : pass.output_textures) {
+			auto result = lifetimes.emplace(pass.texture_name(entry.first), lifetime{index, index, overwrites(*entry.second)});
+			if (!result.second) result.first->second.last = index;
+		}
+	}
+}
+
+void render_graph::compute_aliases( const vector<pass>& passes )
+{
+	aliases.clear();
+
+	unordered_map<string, const gpu::storage_texture*> textures;
+	for (const auto& pass : passes) {
+		for (const auto& entry : pass.input_textures) textures.emplace(pass.texture_name(entry.first), entry.second.get());
+		for (const auto& entry : pass.output_textures) textures.emplace(pass.texture_name(entry.first), entry.second.get());
+	}
+
+	// The transient textures by the start of their lifetimes. Ties are broken
+	// by name such that the aliases do not depend on the hashing.
+	vector<pair<string, lifetime>> transients;
+	for (const auto& entry : lifetimes)
+		if (entry.second.transient) transients.push_back(entry);
+	sort(transients.begin(), transients.end(), [] ( const auto& lhs, const auto& rhs ) {
+		if (lhs.second.first != rhs.second.first) return lhs.second.first < rhs.second.first;
+		return lhs.first < rhs.first;
+	});
+
+	// Greedily reuses the first allocation that is free and alike
+	struct allocation {
+		string name;
+		const gpu::storage_texture* texture;
+		index_type last;
+	};
+	vector<allocation> allocations;
+
+	for (const auto& transient : transients) {
+		const auto& name = transient.first;
+		const auto& lifetime = transient.second;
+		auto texture = textures.at(name);
+
+		auto free_allocation = find_if(allocations.begin(), allocations.end(), [&] ( const allocation& allocation )
+			{ return allocation.last < lifetime.first && is_allocated_alike(*allocation.texture, *texture); });
+
+		if (allocations.end() == free_allocation)
+			allocations.push_back({name, texture, lifetime.last});
+		else {
+			aliases.emplace(name, free_allocation->name);
+			free_allocation->last = lifetime.last;
+		}
+	}
+}
+
+} // namespace rendering
+} // namespace black_label
@@ -0,0 +1,177 @@
+#define BLACK_LABEL_SHARED_LIBRARY_EXPORT
+#include <black_label/rendering/visibility.hpp>
+#include <black_label/rendering/sort_key.hpp>
+#include <black_label/utility/algorithm.hpp>
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_access.hpp>
+
+#include <xmmintrin.h>
+
+
+
+namespace black_label {
+namespace rendering {
+
+using namespace std;
+
+namespace {
+
+// The planes of a view in structure-of-arrays form. Two groups of four
+// planes; the last two slots repeat the first plane. The planes are not
+// normalized since only the sign of the distance is used.
+struct frustum
+{
+	__m128 x[2], y[2], z[2], w[2], absolute_x[2], absolute_y[2], absolute_z[2];
+};
+
+frustum make_frustum( const glm::mat4& view_projection_matrix )
+{
+	glm::vec4 rows[4];
+	for (int i{0}; 4 > i; ++i) rows[i] = glm::row(view_projection_matrix, i);
+	const glm::vec4 planes[8] = {
+		rows[3] + rows[0], rows[3] - rows[0],
+		rows[3] + rows[1], rows[3] - rows[1],
+		rows[3] + rows[2], rows[3] - rows[2],
+		rows[3] + rows[0], rows[3] + rows[0]};
+
+	frustum result;
+	for (int group{0}; 2 > group; ++group) {
+		const auto* p = planes + 4 * group;
+		result.x[group] = _mm_setr_ps(p[0].x, p[1].x, p[2].x, p[3].x);
+		result.y[group] = _mm_setr_ps(p[0].y, p[1].y, p[2].y, p[3].y);
+		result.z[group] = _mm_setr_ps(p[0].z, p[1].z, p[2].z, p[3].z);
+		result.w[group] = _mm_setr_ps(p[0].w, p[1].w, p[2].w, p[3].w);
+		result.absolute_x[group] = _mm_setr_ps(abs(p[0].x), abs(p[1].x), abs(p[2].x), abs(p[3].x));
+		result.absolute_y[group] = _mm_setr_ps(abs(p[0].y), abs(p[1].y), abs(p[2].y), abs(p[3].y));
+		result.absolute_z[group] = _mm_setr_ps(abs(p[0].z), abs(p[1].z), abs(p[2].z), abs(p[3].z));
+	}
+	return result;
+}
+
+// False if the box (center, extent) is entirely outside any of the planes
+bool intersects( const frustum& frustum, __m128 center_x, __m128 center_y, __m128 center_z, __m128 extent_x, __m128 extent_y, __m128 extent_z )
+{
+	for (int group{0}; 2 > group; ++group) {
+		auto center_distance = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(frustum.x[group], center_x), _mm_mul_ps(frustum.y[group], center_y)),
+			_mm_add_ps(_mm_mul_ps(frustum.z[group], center_z), frustum.w[group]));
+		auto extent_distance = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(frustum.absolute_x[group], extent_x), _mm_mul_ps(frustum.absolute_y[group], extent_y)),
+			_mm_mul_ps(frustum.absolute_z[group], extent_z));
+		if (0 != _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(center_distance, extent_distance), _mm_setzero_ps())))
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+
+
+void visibility::update( const instance_batches& batches, vector<const view*> views )
+{
+	if (is_current(batches, views)) return;
+	this->views = move(views);
+	batches_revision = batches.revision;
+	view_states.clear();
+	for (const auto view : this->views)
+		view_states.push_back({view->view_matrix, view->view_projection_matrix});
+
+	cull(batches);
+
+	auto key = [] ( const keyed_index& keyed_index ) { return keyed_index.key; };
+
+	// The visible instances of each batch in each view, front to back
+	batch_count = static_cast<int>(batches.batches.size());
+	ranges.resize(this->views.size() * batch_count);
+	orders.clear();
+	visible_instances.clear();
+	for (size_t view_index{0}; this->views.size() > view_index; ++view_index) {
+		auto culled = static_cast<size_t>(max_culled_view_count) > view_index;
+		auto bit = culled ? mask_type{1} << view_index : mask_type{0};
+		auto range = ranges.begin() + view_index * batch_count;
+		// The depth is the negated eye-space z
+		auto depth_row = -glm::row(this->views[view_index]->view_matrix, 2);
+
+		for (const auto& batch : batches.batches) {
+			keyed.clear();
+			for (int instance{batch.offset}; batch.offset + batch.count > instance; ++instance)
+				if (!culled || 0 != (masks[instance] & bit))
+					keyed.push_back({make_depth_key(glm::dot(depth_row, glm::vec4{centers[instance], 1.0f})), instance});
+			utility::radix_sort(keyed, keyed_buffer, key);
+
+			range->offset = static_cast<int>(visible_instances.size());
+			range->count = static_cast<int>(keyed.size());
+			range->depth_key = keyed.empty() ? ~std::uint32_t{0} : keyed.front().key;
+			for (const auto& instance : keyed) visible_instances.push_back(instance.index);
+			++range;
+		}
+
+		// The batches by their nearest visible instance
+		keyed.clear();
+		range = ranges.begin() + view_index * batch_count;
+		for (int batch{0}; batch_count > batch; ++batch)
+			keyed.push_back({range[batch].depth_key, batch});
+		utility::radix_sort(keyed, keyed_buffer, key);
+		for (const auto& batch : keyed) orders.push_back(batch.index);
+	}
+
+	if (!visible_instances.empty())
+		buffer.bind_and_update(static_cast<gpu::buffer::size_type>(visible_instances.size() * sizeof(int)), visible_instances.data());
+
+	draws.update(batches, *this);
+}
+
+bool visibility::is_current( const instance_batches& batches, const vector<const view*>& views ) const
+{
+	if (batches.revision != batches_revision || this->views != views) return false;
+	for (size_t view_index{0}; views.size() > view_index; ++view_index)
+		if (views[view_index]->view_matrix != view_states[view_index].view_matrix
+			|| views[view_index]->view_projection_matrix != view_states[view_index].view_projection_matrix)
+			return false;
+	return true;
+}
+
+void visibility::cull( const instance_batches& batches )
+{
+	vector<frustum> frustums;
+	auto culled_view_count = min(views.size(), static_cast<size_t>(max_culled_view_count));
+	for (size_t view_index{0}; culled_view_count > view_index; ++view_index)
+		frustums.push_back(make_frustum(views[view_index]->view_projection_matrix));
+
+	masks.assign(batches.instances.size(), 0);
+	centers.resize(batches.instances.size());
+	for (const auto& batch : batches.batches) {
+		// Models that are not loaded are visible nowhere
+		if (!batch.model->has_bounds()) {
+			for (int instance{batch.offset}; batch.offset + batch.count > instance; ++instance)
+				centers[instance] = glm::vec3{batches.instances[instance].model_matrix[3]};
+			continue;
+		}
+		auto center = (batch.model->lower_bound + batch.model->upper_bound) * 0.5f;
+		auto extent = (batch.model->upper_bound - batch.model->lower_bound) * 0.5f;
+
+		for (int instance{batch.offset}; batch.offset + batch.count > instance; ++instance) {
+			const auto& model_matrix = batches.instances[instance].model_matrix;
+			glm::vec3 wc_center{model_matrix * glm::vec4{center, 1.0f}};
+			centers[instance] = wc_center;
+			glm::mat3 absolute{glm::abs(glm::vec3{model_matrix[0]}), glm::abs(glm::vec3{model_matrix[1]}), glm::abs(glm::vec3{model_matrix[2]})};
+			glm::vec3 wc_extent{absolute * extent};
+
+			auto center_x = _mm_set1_ps(wc_center.x), center_y = _mm_set1_ps(wc_center.y), center_z = _mm_set1_ps(wc_center.z);
+			auto extent_x = _mm_set1_ps(wc_extent.x), extent_y = _mm_set1_ps(wc_extent.y), extent_z = _mm_set1_ps(wc_extent.z);
+
+			mask_type mask{0};
+			for (size_t view_index{0}; frustums.size() > view_index; ++view_index)
+				if (intersects(frustums[view_index], center_x, center_y, center_z, extent_x, extent_y, extent_z))
+					mask |= mask_type{1} << view_index;
+			masks[instance] = mask;
+		}
+	}
+}
+
+} // namespace rendering
+} // namespace black_label
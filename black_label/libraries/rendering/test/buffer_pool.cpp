@@ -0,0 +1,95 @@
+#include <black_label/rendering/gpu/buffer_pool.hpp>
+
+#define BOOST_TEST_MODULE buffer_pool
+#include <boost/test/unit_test.hpp>
+
+using namespace black_label::rendering::gpu;
+
+
+
+namespace {
+
+const buffer_pool::size_type kilobyte{1024}, min_size{buffer_pool::min_size};
+const int shrink_delay{buffer_pool::shrink_delay};
+
+} // namespace
+
+
+
+BOOST_AUTO_TEST_CASE( grows_to_powers_of_two )
+{
+	buffer_pool pool;
+	BOOST_CHECK_EQUAL(min_size, pool.request("data", 0, 1));
+	BOOST_CHECK_EQUAL(min_size, pool.request("data", 0, min_size));
+	BOOST_CHECK_EQUAL(2 * min_size, pool.request("data", min_size, min_size + 1));
+	BOOST_CHECK_EQUAL(8 * min_size, pool.request("data", 2 * min_size, 5 * min_size));
+	BOOST_CHECK_EQUAL(4u, pool.entries.at("data").reallocations);
+}
+
+BOOST_AUTO_TEST_CASE( keeps_allocations_that_fit )
+{
+	buffer_pool pool;
+	auto allocated_size = 8 * min_size;
+	// Down to just above a quarter of the allocation
+	for (auto size : {8 * min_size, 5 * min_size, 2 * min_size + 1})
+		BOOST_CHECK_EQUAL(allocated_size, pool.request("data", allocated_size, size));
+	BOOST_CHECK_EQUAL(0u, pool.entries.at("data").reallocations);
+}
+
+BOOST_AUTO_TEST_CASE( shrinks_after_delay )
+{
+	buffer_pool pool;
+	auto allocated_size = 8 * min_size;
+	for (int i{1}; shrink_delay > i; ++i)
+		BOOST_CHECK_EQUAL(allocated_size, pool.request("data", allocated_size, kilobyte));
+	BOOST_CHECK_EQUAL(min_size, pool.request("data", allocated_size, kilobyte));
+	BOOST_CHECK_EQUAL(1u, pool.entries.at("data").reallocations);
+}
+
+BOOST_AUTO_TEST_CASE( shrinks_to_largest_size_of_delay )
+{
+	buffer_pool pool;
+	auto allocated_size = 16 * min_size;
+	pool.request("data", allocated_size, 3 * min_size);
+	for (int i{2}; shrink_delay >= i; ++i)
+		allocated_size = pool.request("data", allocated_size, kilobyte);
+	BOOST_CHECK_EQUAL(4 * min_size, allocated_size);
+}
+
+BOOST_AUTO_TEST_CASE( large_size_restarts_delay )
+{
+	buffer_pool pool;
+	auto allocated_size = 8 * min_size;
+	for (int i{1}; shrink_delay > i; ++i)
+		pool.request("data", allocated_size, kilobyte);
+	// Above a quarter of the allocation
+	pool.request("data", allocated_size, 3 * min_size);
+	for (int i{1}; shrink_delay > i; ++i)
+		BOOST_CHECK_EQUAL(allocated_size, pool.request("data", allocated_size, kilobyte));
+	BOOST_CHECK_EQUAL(min_size, pool.request("data", allocated_size, kilobyte));
+}
+
+BOOST_AUTO_TEST_CASE( never_shrinks_below_min_size )
+{
+	buffer_pool pool;
+	for (int i{0}; 2 * shrink_delay > i; ++i)
+		BOOST_CHECK_EQUAL(min_size, pool.request("data", min_size, 0));
+	BOOST_CHECK_EQUAL(0u, pool.entries.at("data").reallocations);
+}
+
+BOOST_AUTO_TEST_CASE( tracks_high_water_marks_by_name )
+{
+	buffer_pool pool;
+	auto data_size = pool.request("data", 0, 3 * min_size);
+	pool.request("data", data_size, kilobyte);
+	pool.request("photons", 0, kilobyte);
+
+	const auto& data = pool.entries.at("data");
+	BOOST_CHECK_EQUAL(kilobyte, data.size);
+	BOOST_CHECK_EQUAL(3 * min_size, data.high_water_mark);
+	BOOST_CHECK_EQUAL(4 * min_size, data.allocated_size);
+
+	const auto& photons = pool.entries.at("photons");
+	BOOST_CHECK_EQUAL(kilobyte, photons.high_water_mark);
+	BOOST_CHECK_EQUAL(min_size, photons.allocated_size);
+}
@@ -0,0 +1,209 @@
+#include <black_label/rendering/render_graph.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#define BOOST_TEST_MODULE render_graph
+#include <boost/test/unit_test.hpp>
+
+using namespace black_label::rendering;
+using namespace black_label::rendering::gpu;
+using namespace std;
+
+
+
+namespace {
+
+using index_vector = vector<render_graph::index_type>;
+
+// Makes no OpenGL calls since nothing is allocated
+shared_ptr<storage_texture> make_texture( format::type format = format::rgba8 )
+{
+	auto result = make_shared<storage_texture>();
+	result->target = target::texture_2d;
+	result->format = format;
+	result->filter = filter::nearest;
+	result->wrap = wrap::clamp_to_edge;
+	result->width = 1.0f;
+	result->height = 1.0f;
+	return result;
+}
+
+// Without outputs, the pass draws to the screen
+pass make_pass(
+	string name,
+	pass::texture_container input_textures,
+	pass::texture_container output_textures,
+	unsigned int clearing_mask = 0u,
+	pass::buffer_container buffers = pass::buffer_container{} )
+{
+	return pass{
+		move(name),
+		nullptr,
+		move(input_textures),
+		move(output_textures),
+		pass::view_container{},
+		move(buffers),
+		pass::index_bound_buffer_container{},
+		clearing_mask,
+		0u,
+		0u,
+		render_mode{},
+		nullptr,
+		nullptr};
+}
+
+} // namespace
+
+
+
+BOOST_AUTO_TEST_CASE( culls_passes_that_do_not_reach_the_screen )
+{
+	auto unused = make_texture(), lit = make_texture();
+	vector<pass> passes;
+	passes.push_back(make_pass("unused", {}, {{"unused", unused}}));
+	passes.push_back(make_pass("lighting", {}, {{"lit", lit}}));
+	passes.push_back(make_pass("screen", {{"lit", lit}}, {}));
+
+	render_graph graph{passes};
+	BOOST_CHECK(graph.is_culled(0));
+	BOOST_CHECK(!graph.is_culled(1));
+	BOOST_CHECK(!graph.is_culled(2));
+	BOOST_CHECK(index_vector{1} == graph.dependencies[2]);
+	// Only live passes give lifetimes
+	BOOST_CHECK(!graph.lifetimes.count("unused"));
+	BOOST_CHECK(graph.lifetimes.count("lit"));
+}
+
+BOOST_AUTO_TEST_CASE( buffers_keep_passes_live )
+{
+	vector<pass> passes;
+	passes.push_back(make_pass("counting", {}, {{"unused", make_texture()}}, 0u, {{"counter", make_shared<buffer>()}}));
+	passes.push_back(make_pass("reading", {}, {{"unused", make_texture()}}, 0u, {{"counter", make_shared<buffer>()}}));
+
+	render_graph graph{passes};
+	BOOST_CHECK(!graph.is_culled(0));
+	BOOST_CHECK(!graph.is_culled(1));
+	BOOST_CHECK(index_vector{0} == graph.dependencies[1]);
+}
+
+BOOST_AUTO_TEST_CASE( follows_renamed_textures )
+{
+	// A pass with a resolution between its resampling passes (see
+	// pipeline::import)
+	auto depths = make_texture(format::depth24), depths_50 = make_texture(format::depth24);
+	auto ao = make_texture(), ao_50 = make_texture();
+	vector<pass> passes;
+	passes.push_back(make_pass("buffering", {}, {{"depths", depths}}));
+	passes.push_back(make_pass("ao_downsampling", {{"source_depth", depths}}, {{"depth", depths_50}}));
+	passes.back().texture_names = {{"source_depth", "depths"}, {"depth", "depths_50"}};
+	passes.push_back(make_pass("ao", {{"depths", depths_50}}, {{"ao", ao_50}}, GL_COLOR_BUFFER_BIT));
+	passes.back().texture_names = {{"depths", "depths_50"}, {"ao", "ao_50"}};
+	passes.push_back(make_pass("ao_upsampling", {{"source_0", ao_50}}, {{"result_0", ao}}));
+	passes.back().texture_names = {{"source_0", "ao_50"}, {"result_0", "ao"}};
+	passes.push_back(make_pass("screen", {{"ao", ao}}, {}));
+
+	render_graph graph{passes};
+	for (render_graph::index_type index{0}; passes.size() > index; ++index)
+		BOOST_CHECK(!graph.is_culled(index));
+	for (render_graph::index_type index{1}; passes.size() > index; ++index)
+		BOOST_CHECK(index_vector{index - 1} == graph.dependencies[index]);
+
+	BOOST_CHECK(!graph.lifetimes.count("source_depth"));
+	BOOST_REQUIRE(graph.lifetimes.count("depths_50"));
+	BOOST_CHECK_EQUAL(1u, graph.lifetimes.at("depths_50").first);
+	BOOST_CHECK_EQUAL(2u, graph.lifetimes.at("depths_50").last);
+	BOOST_REQUIRE(graph.lifetimes.count("ao_50"));
+	BOOST_CHECK(graph.lifetimes.at("ao_50").transient);
+}
+
+BOOST_AUTO_TEST_CASE( aliases_transients_with_disjoint_lifetimes )
+{
+	auto first = make_texture(), second = make_texture(), third = make_texture();
+	vector<pass> passes;
+	passes.push_back(make_pass("first", {}, {{"first", first}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("second", {{"first", first}}, {{"second", second}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("third", {{"second", second}}, {{"third", third}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("screen", {{"third", third}}, {}));
+
+	render_graph graph{passes};
+	BOOST_REQUIRE_EQUAL(1u, graph.aliases.size());
+	BOOST_CHECK_EQUAL("first", graph.aliases.at("third"));
+}
+
+BOOST_AUTO_TEST_CASE( aliases_textures_covered_by_screen_aligned_quads )
+{
+	auto first = make_texture(), second = make_texture(), third = make_texture();
+	vector<pass> passes;
+	passes.push_back(make_pass("first", {}, {{"first", first}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("second", {{"first", first}}, {{"second", second}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("third", {{"second", second}}, {{"third", third}}));
+	passes.back().render_mode.set(render_mode::screen_aligned_quad);
+	passes.push_back(make_pass("screen", {{"third", third}}, {}));
+
+	render_graph graph{passes};
+	BOOST_CHECK(graph.lifetimes.at("third").transient);
+	BOOST_CHECK_EQUAL(1u, graph.aliases.count("third"));
+}
+
+BOOST_AUTO_TEST_CASE( does_not_alias_textures_first_written_without_clearing )
+{
+	// The third pass may blend or depth test against what is in third
+	auto first = make_texture(), second = make_texture(), third = make_texture();
+	vector<pass> passes;
+	passes.push_back(make_pass("first", {}, {{"first", first}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("second", {{"first", first}}, {{"second", second}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("third", {{"second", second}}, {{"third", third}}));
+	passes.push_back(make_pass("screen", {{"third", third}}, {}));
+
+	render_graph graph{passes};
+	BOOST_CHECK(!graph.lifetimes.at("third").transient);
+	BOOST_CHECK(graph.aliases.empty());
+}
+
+BOOST_AUTO_TEST_CASE( clearing_must_match_the_format )
+{
+	// Clearing the color does not clear a depth texture
+	auto first = make_texture(format::depth24), second = make_texture(), third = make_texture(format::depth24);
+	vector<pass> passes;
+	passes.push_back(make_pass("first", {}, {{"first", first}}, GL_DEPTH_BUFFER_BIT));
+	passes.push_back(make_pass("second", {{"first", first}}, {{"second", second}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("third", {{"second", second}}, {{"third", third}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("screen", {{"third", third}}, {}));
+
+	render_graph graph{passes};
+	BOOST_CHECK(graph.lifetimes.at("first").transient);
+	BOOST_CHECK(!graph.lifetimes.at("third").transient);
+	BOOST_CHECK(graph.aliases.empty());
+}
+
+BOOST_AUTO_TEST_CASE( does_not_alias_textures_allocated_differently )
+{
+	auto first = make_texture(), second = make_texture(), third = make_texture(format::rgba16f);
+	vector<pass> passes;
+	passes.push_back(make_pass("first", {}, {{"first", first}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("second", {{"first", first}}, {{"second", second}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("third", {{"second", second}}, {{"third", third}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("screen", {{"third", third}}, {}));
+
+	render_graph graph{passes};
+	BOOST_CHECK(graph.aliases.empty());
+}
+
+BOOST_AUTO_TEST_CASE( does_not_alias_textures_read_before_written )
+{
+	// history is read before it is written, so it outlives the frame
+	auto history = make_texture(), second = make_texture(), third = make_texture();
+	vector<pass> passes;
+	passes.push_back(make_pass("first", {{"history", history}}, {{"history", history}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("second", {{"history", history}}, {{"second", second}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("third", {{"second", second}}, {{"third", third}}, GL_COLOR_BUFFER_BIT));
+	passes.push_back(make_pass("screen", {{"third", third}}, {}));
+
+	render_graph graph{passes};
+	BOOST_CHECK(!graph.lifetimes.at("history").transient);
+	BOOST_CHECK(graph.aliases.empty());
+}
@@ -0,0 +1,97 @@
+#include <black_label/utility/algorithm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_MODULE radix_sort
+#include <boost/test/unit_test.hpp>
+
+using namespace black_label::utility;
+using namespace std;
+
+
+
+namespace {
+
+// The key and the original position
+using value_type = pair<uint64_t, int>;
+
+uint64_t key( const value_type& value ) { return value.first; }
+
+vector<value_type> make_values( vector<uint64_t> keys )
+{
+	vector<value_type> result;
+	for (int i{0}; static_cast<int>(keys.size()) > i; ++i)
+		result.emplace_back(keys[i], i);
+	return result;
+}
+
+} // namespace
+
+
+
+BOOST_AUTO_TEST_CASE( empty_and_single )
+{
+	vector<value_type> values, buffer;
+	radix_sort(values, buffer, key);
+	BOOST_CHECK(values.empty());
+
+	values = make_values({42});
+	radix_sort(values, buffer, key);
+	BOOST_REQUIRE_EQUAL(1u, values.size());
+	BOOST_CHECK_EQUAL(42u, values[0].first);
+}
+
+BOOST_AUTO_TEST_CASE( matches_stable_sort )
+{
+	mt19937_64 random_number_generator;
+	// Few distinct keys such that many are equal and spread over all bytes
+	uniform_int_distribution<int> distribution(0, 15);
+	vector<uint64_t> keys(10000);
+	for (auto& key : keys) {
+		auto digit = distribution(random_number_generator);
+		key = static_cast<uint64_t>(digit) << (4 * (digit % 16));
+	}
+
+	auto values = make_values(keys), expected = values;
+	stable_sort(expected.begin(), expected.end(), [] ( const value_type& lhs, const value_type& rhs )
+		{ return lhs.first < rhs.first; });
+
+	vector<value_type> buffer;
+	radix_sort(values, buffer, key);
+	BOOST_CHECK(expected == values);
+}
+
+BOOST_AUTO_TEST_CASE( equal_keys_keep_their_order )
+{
+	auto values = make_values({3, 1, 3, 1, 3, 1});
+	vector<value_type> buffer;
+	radix_sort(values, buffer, key);
+
+	auto expected = vector<value_type>{{1, 1}, {1, 3}, {1, 5}, {3, 0}, {3, 2}, {3, 4}};
+	BOOST_CHECK(expected == values);
+}
+
+BOOST_AUTO_TEST_CASE( constant_bytes_are_skipped )
+{
+	// Only the highest and the lowest byte differ
+	auto high = uint64_t{1} << 56;
+	auto values = make_values({high + 2, 1, high + 1, 2});
+	vector<value_type> buffer;
+	radix_sort(values, buffer, key);
+
+	auto expected = vector<value_type>{{1, 1}, {2, 3}, {high + 1, 2}, {high + 2, 0}};
+	BOOST_CHECK(expected == values);
+}
+
+BOOST_AUTO_TEST_CASE( all_keys_equal )
+{
+	auto values = make_values({7, 7, 7});
+	auto expected = values;
+	vector<value_type> buffer;
+	radix_sort(values, buffer, key);
+	BOOST_CHECK(expected == values);
+}
@@ -90,6 +90,12 @@ int main( int argc, char const* argv[] )
 		options options{argc, argv};
 		if (options.user_requested_help) return EXIT_SUCCESS;
 		if (!options.window.complete) return EXIT_FAILURE;
+		if (options.user_requested_cache_archive) {
+			if (!options.rendering.complete) return EXIT_FAILURE;
+			auto& directory = options.rendering.asset_directory;
+			return black_label::utility::cache_archive::pack(directory, directory / black_label::utility::cache_archive::default_file_name())
+				? EXIT_SUCCESS : EXIT_FAILURE;
+		}
 
 		view view{
 			glm::vec3{1200.0f, 200.0f, 200.0f}, 
@@ -100,12 +106,19 @@ int main( int argc, char const* argv[] )
 		
 		black_label::rendering::initialize();
 
+		// Linked programs are cached across runs
+		black_label::system::error_code error_code;
+		auto temporary_directory = boost::filesystem::temp_directory_path(error_code);
+		if (!error_code)
+			program::binary_cache_directory = temporary_directory / "black_label" / "program_binaries";
+
 		pipeline rendering_pipeline = (options.rendering.complete)
 			? pipeline{&view, options.rendering.shader_directory, options.rendering.pipeline}
 			: pipeline{&view};
 
 		gpu::framebuffer framebuffer{black_label::rendering::generate};
 		rendering_assets_type rendering_assets{options.rendering.asset_directory};
+		rendering_assets.gpu_memory_budget = options.rendering.gpu_memory_budget * 1000000ull;
 
 		auto write_access_file_name = filter::write | filter::access | filter::file_name;
 		file_system_watcher file_system_watcher = {
@@ -130,6 +143,7 @@ int main( int argc, char const* argv[] )
 				file_system_watcher.subscribe(current.asset_directory, write_access_file_name);
 
 				rendering_assets.asset_directory = current.asset_directory;
+				rendering_assets.open_cache_archive();
 				rendering_assets.import_missing_models();
 			}
 			if (former.shader_directory != current.shader_directory) {
@@ -142,6 +156,7 @@ int main( int argc, char const* argv[] )
 			}
 			if (former.pipeline != current.pipeline)
 				rendering_pipeline.import(current.pipeline);
+			rendering_assets.gpu_memory_budget = current.gpu_memory_budget * 1000000ull;
 		};
 
 		window.on_resized = [&] ( int width, int height ) {
@@ -180,8 +195,10 @@ int main( int argc, char const* argv[] )
 				rendering_pipeline.render(framebuffer, rendering_assets);
 				// Overlay rendering statistics
 				if (!was_t_pressed)
-					draw_statistics(window, options.rendering.asset_directory, rendering_pipeline, options.is_complete());
+					draw_statistics(window, options.rendering.asset_directory, rendering_pipeline, rendering_assets, options.is_complete());
 				window.window_.display();
+				// SFML changes the OpenGL state behind the back of the state cache
+				black_label::rendering::gpu::state_cache::get().invalidate();
 			}
 
 
@@ -50,17 +50,20 @@ bool window_options::parse_and_validate() {
 ////////////////////////////////////////////////////////////////////////////////
 rendering_options::rendering_options() noexcept
 	: basic_options{"rendering"}
+	, gpu_memory_budget{0}
 {
 	description.add_options()
 		("rendering.shader_directory", po::value<path>(&shader_directory), "Path to the shader directory. May be relative to the working directory.")
 		("rendering.asset_directory", po::value<path>(&asset_directory), "Path to the asset directory. May be relative to the working directory.")
-		("rendering.pipeline", po::value<path>(&pipeline)->default_value("default.pipeline.json"), "Path to the rendering pipeline file. May be relative to the shader directory.");
+		("rendering.pipeline", po::value<path>(&pipeline)->default_value("default.pipeline.json"), "Path to the rendering pipeline file. May be relative to the shader directory.")
+		("rendering.gpu_memory_budget", po::value<int>(&gpu_memory_budget)->default_value(gpu_memory_budget), "GPU memory budget in megabytes. Textures lose mipmap levels when the budget is exceeded. Zero disables the budget.");
 }
 
 void rendering_options::export( ptree& root ) const {
 	root.put("rendering.shader_directory", shader_directory);
 	root.put("rendering.asset_directory", asset_directory);
 	root.put("rendering.pipeline", pipeline);
+	root.put("rendering.gpu_memory_budget", std::to_string(gpu_memory_budget));
 }
 
 
@@ -77,6 +80,7 @@ bool rendering_options::parse_and_validate() {
 	if (!is_directory(asset_directory)) throw std::logic_error(asset_directory.string() + " is not a directory.");
 	auto canonical_pipeline = canonical_and_preferred(pipeline, shader_directory);
 	if (!is_regular_file(canonical_pipeline)) throw std::logic_error(canonical_pipeline.string() + " is not a file.");
+	if (0 > gpu_memory_budget) throw std::logic_error("GPU memory budget must not be negative");
 }
 
 
@@ -88,11 +92,14 @@ const black_label::path options::configuration_file_path{"configuration.ini"};
 
 options::options( int argc, const char* argv[] ) noexcept
 	: user_requested_help{false}
+	, user_requested_cache_archive{false}
 {
 	description
 		.add(window.description)
 		.add(rendering.description)
-		.add_options()("help,h", "Prints this message.");
+		.add_options()
+			("help,h", "Prints this message.")
+			("pack-cache-archive", "Packs the cache files of the asset directory into a single archive and exits.");
 
 	variables_map variables_map;
 
@@ -161,6 +168,8 @@ void options::set_variables( variables_map& variables_map ) {
 	// Store the options into the member variables
 	notify(variables_map);
 
+	user_requested_cache_archive = 0 != variables_map.count("pack-cache-archive");
+
 	parse_and_validate();
 }
 
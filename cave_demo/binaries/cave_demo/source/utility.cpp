@@ -100,6 +100,7 @@ void draw_statistics(
 	window& window,
 	const black_label::path& asset_directory,
 	const black_label::rendering::pipeline& rendering_pipeline,
+	const rendering_assets_type& rendering_assets,
 	bool options_complete )
 {
 	static sf::Font font;
@@ -122,44 +123,66 @@ void draw_statistics(
 	gpu::framebuffer::unbind();
 	window.window_.resetGLStates();
 
-	static bool has_written_message{false};
+	static const char* written_message{nullptr};
 	if (options_complete && rendering_pipeline.is_complete()) {
-		has_written_message = false;
+		written_message = nullptr;
 		static unordered_map<string, double> averages;
 		stringstream ss;
 		ss.precision(4);
-		auto output_pass = [&] ( const std::string& name, const chrono::high_resolution_clock::duration& render_duration )
-		{ 
-			if (10s < render_duration || 10us > render_duration) return;
-			auto render_time = duration_cast<duration<double, milli>>(render_duration).count();
+		auto average = [&] ( const std::string& name, double time )
+		{
 			static const double alpha{0.75};
-			averages[name] = alpha * render_time + (1.0 - alpha) * averages[name];
-			ss << name << " [ms]: " << render_time << " (" << averages[name] << ")\n"; 
+			return averages[name] = alpha * time + (1.0 - alpha) * averages[name];
+		};
+		// CPU submission and GPU execution times
+		auto output_pass = [&] ( const std::string& name, const chrono::high_resolution_clock::duration& cpu_duration, const chrono::nanoseconds& gpu_duration )
+		{ 
+			if (10s < cpu_duration || 10us > cpu_duration) return;
+			auto cpu_time = duration_cast<duration<double, milli>>(cpu_duration).count();
+			auto gpu_time = duration_cast<duration<double, milli>>(gpu_duration).count();
+			ss << name << " [ms]: cpu " << cpu_time << " (" << average(name + " cpu", cpu_time) << ")"
+				<< " gpu " << gpu_time << " (" << average(name + " gpu", gpu_time) << ")\n"; 
 		};
 
-		output_pass("rendering_pipeline.json", rendering_pipeline.render_time);
+		output_pass("rendering_pipeline.json", rendering_pipeline.render_time, rendering_pipeline.timer.gpu_time);
 
 		output_pass(
 			"\t" + rendering_pipeline.shadow_mapping.name, 
-			rendering_pipeline.shadow_mapping.render_time);
+			rendering_pipeline.shadow_mapping.render_time,
+			rendering_pipeline.shadow_mapping.timer.gpu_time);
 
 		auto all_passes = rendering_pipeline.shadow_mapping.render_time;
+		auto all_passes_gpu = rendering_pipeline.shadow_mapping.timer.gpu_time;
 		chrono::high_resolution_clock::duration ldm{0};
+		chrono::nanoseconds ldm_gpu{0};
 		for (const auto& pass : rendering_pipeline.passes) {
 			all_passes += pass.render_time;
+			all_passes_gpu += pass.timer.gpu_time;
 			if ("ldm" == pass.name.substr(0, 3)) {
 				ldm += pass.render_time;
+				ldm_gpu += pass.timer.gpu_time;
 				continue;
 			}
-			output_pass("\t" + pass.name, pass.render_time);
+			output_pass("\t" + pass.name, pass.render_time, pass.timer.gpu_time);
+			if (pass.is_scalable())
+				ss << "\t\trender_scale: " << pass.render_scale << "\n";
 		}
 	
-		output_pass("\tldm (all passes)", ldm);
+		output_pass("\tldm (all passes)", ldm, ldm_gpu);
 
-		output_pass("\t(sequencing overhead)", rendering_pipeline.render_time - all_passes);
+		output_pass("\t(sequencing overhead)", 
+			rendering_pipeline.render_time - all_passes, 
+			rendering_pipeline.timer.gpu_time - all_passes_gpu);
 
-		ss << "data_buffer_size" << " [MB]: " << rendering_pipeline.data_buffer_size * 1.0e-6f << "\n"; 
-		ss << "photon_buffer_size" << " [MB]: " << rendering_pipeline.photon_buffer_size * 1.0e-6f << "\n"; 
+		ss << rendering_pipeline.buffer_pool;
+		ss << gpu::state_cache::get().last_frame;
+
+		// Querying walks all statics so only do it once in a while
+		static black_label::rendering::memory_statistics memory_statistics;
+		static unsigned int frames_since_memory_query{0};
+		if (0 == frames_since_memory_query++ % 60) memory_statistics = rendering_assets.get_memory_statistics();
+		ss << memory_statistics;
+		ss << "total" << " [MB]: " << memory_statistics.total() * 1.0e-6 << "\n";
 
 		text.setString(ss.str());
 		text.setCharacterSize(16);
@@ -172,14 +195,19 @@ void draw_statistics(
 		text.setPosition(5, 0);
 		window.window_.draw(text);
 	}
-	else if (!has_written_message) {
-		has_written_message = true;
+	else {
+		auto message = (options_complete && rendering_pipeline.is_pending())
+			? "Compiling shaders..."
+			: "Error in rendering config.";
+		if (message == written_message) return;
+		written_message = message;
+
 		auto window_size = window.window_.getSize();
 		sf::RectangleShape rectangle{sf::Vector2f{window_size}};
 		rectangle.setFillColor(sf::Color{0, 0, 0, 180});
 		window.window_.draw(rectangle);
 		
-		text.setString("Error in rendering config.");
+		text.setString(message);
 		text.setCharacterSize(22);
 		sf::FloatRect textBounds = text.getLocalBounds();
 		text.setPosition(sf::Vector2f(
@@ -70,10 +70,13 @@ public:
 	{
 		return lhs.shader_directory == rhs.shader_directory 
 			&& lhs.asset_directory == rhs.asset_directory
-			&& lhs.pipeline == rhs.pipeline;
+			&& lhs.pipeline == rhs.pipeline
+			&& lhs.gpu_memory_budget == rhs.gpu_memory_budget;
 	}
 
 	black_label::path shader_directory, asset_directory, pipeline;
+	// In megabytes. Zero disables the budget.
+	int gpu_memory_budget;
 	std::function<void ( rendering_options& current, rendering_options former )> on_reload;
 };
 
@@ -94,7 +97,7 @@ public:
 
 	window_options window;
 	rendering_options rendering;
-	bool user_requested_help;
+	bool user_requested_help, user_requested_cache_archive;
 
 
 protected:
@@ -23,6 +23,7 @@ void draw_statistics(
 	window& window,
 	const black_label::path& asset_directory, 
 	const black_label::rendering::pipeline& rendering_pipeline,
+	const rendering_assets_type& rendering_assets,
 	bool options_complete );
 
 } // namespace cave_demo